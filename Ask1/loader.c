@@ -0,0 +1,213 @@
+#include "loader.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MIN_CHUNK 65536
+#define MIN_ROW 15          // "1,a,0,,Crew,No\n": no chunk holds more rows than bytes / MIN_ROW
+
+static const char *duplicate_reason = "duplicate code";
+
+typedef struct reject {
+    long line;                  // Line number within the chunk, from 0
+    size_t offset, length;
+    const char *reason;
+} reject_t;
+
+// What one thread validated, in file order
+typedef struct chunk {
+    const char *data;
+    size_t begin, end;
+
+    passenger_t *rows;
+    long *row_lines;            // Line number of each row, for duplicate reports
+    size_t *row_offsets;
+    long num_rows, rows_capacity;
+    reject_t *rejects;
+    long num_rejects, rejects_capacity;
+    long num_lines;
+} chunk_t;
+
+static void *resize(void *items, long capacity, size_t item_size) {
+    items = realloc(items, item_size * capacity);
+    if (!items) {
+        perror("realloc");
+        exit(EXIT_FAILURE);
+    }
+    return items;
+}
+
+static void *validate_chunk(void *arg) {
+    chunk_t *chunk = arg;
+    size_t pos = chunk->begin;
+
+    // Sized for the worst case up front: the pages a short file never touches
+    // cost nothing, and the rows are never copied by a realloc
+    chunk->rows_capacity = (chunk->end - chunk->begin) / MIN_ROW + 1;
+    chunk->rows = resize(NULL, chunk->rows_capacity, sizeof(passenger_t));
+    chunk->row_lines = resize(NULL, chunk->rows_capacity, sizeof(long));
+    chunk->row_offsets = resize(NULL, chunk->rows_capacity, sizeof(size_t));
+
+    while (pos < chunk->end) {
+        const char *newline = memchr(chunk->data + pos, '\n', chunk->end - pos);
+        size_t line_end = newline ? (size_t)(newline - chunk->data) : chunk->end;
+        size_t length = line_end - pos;
+        if (length > 0 && chunk->data[line_end - 1] == '\r') length--;
+        long line = chunk->num_lines++;
+
+        if (length > 0) {
+            const char *error;
+            if (passenger_parse(chunk->data + pos, length, &chunk->rows[chunk->num_rows], &error) == 0) {
+                chunk->row_lines[chunk->num_rows] = line;
+                chunk->row_offsets[chunk->num_rows] = pos;
+                chunk->num_rows++;
+            } else {
+                if (chunk->num_rejects == chunk->rejects_capacity) {
+                    chunk->rejects_capacity = chunk->rejects_capacity ? chunk->rejects_capacity * 2 : 1024;
+                    chunk->rejects = resize(chunk->rejects, chunk->rejects_capacity, sizeof(reject_t));
+                }
+                chunk->rejects[chunk->num_rejects++] = (reject_t){ line, pos, length, error };
+            }
+        }
+        pos = line_end + 1;
+    }
+    return NULL;
+}
+
+// Chunk boundaries fall just after a newline, so every line belongs to one chunk
+static size_t line_start_after(const char *data, size_t size, size_t pos) {
+    if (pos == 0) return 0;
+    const char *newline = memchr(data + pos - 1, '\n', size - pos + 1);
+    return newline ? (size_t)(newline - data) + 1 : size;
+}
+
+static void count_reason(load_stats_t *stats, const char *reason) {
+    stats->rejected++;
+    for (int i = 0; i < stats->num_reasons; i++) {
+        if (strcmp(stats->reasons[i], reason) == 0) {
+            stats->reason_counts[i]++;
+            return;
+        }
+    }
+    if (stats->num_reasons < LOADER_MAX_REASONS) {
+        stats->reasons[stats->num_reasons] = reason;
+        stats->reason_counts[stats->num_reasons++] = 1;
+    }
+}
+
+static void report_reject(FILE *rejects, const char *data, long line, size_t offset, size_t length,
+                          const char *reason) {
+    if (!rejects) return;
+    fprintf(rejects, "line %ld: %s: ", line, reason);
+    fwrite(data + offset, 1, length, rejects);
+    fputc('\n', rejects);
+}
+
+static size_t line_length(const char *data, size_t size, size_t offset) {
+    const char *newline = memchr(data + offset, '\n', size - offset);
+    size_t end = newline ? (size_t)(newline - data) : size;
+    if (end > offset && data[end - 1] == '\r') end--;
+    return end - offset;
+}
+
+int load_csv(store_t *store, const char *csv, int threads, FILE *rejects, load_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    int fd = open(csv, O_RDONLY);
+    if (fd == -1) return -1;
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        return -1;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int saved = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+        errno = saved;
+        return -1;
+    }
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+
+    if (threads <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cores > 0 ? (int)cores : 1;
+    }
+    // Small files are not worth a thread per chunk
+    if ((size_t)threads > size / MIN_CHUNK + 1) threads = (int)(size / MIN_CHUNK + 1);
+
+    chunk_t *chunks = calloc(threads, sizeof(chunk_t));
+    pthread_t *ids = malloc(sizeof(pthread_t) * threads);
+    if (!chunks || !ids) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < threads; i++) {
+        chunks[i].data = data;
+        chunks[i].begin = line_start_after(data, size, size / threads * i);
+        chunks[i].end = i + 1 < threads ? line_start_after(data, size, size / threads * (i + 1)) : size;
+        if (pthread_create(&ids[i], NULL, validate_chunk, &chunks[i]) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    long valid = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+        valid += chunks[i].num_rows;
+    }
+
+    // One resize for the whole load, then the rows go in in file order
+    if (store_reserve(store, store_count(store) + valid) == -1) {
+        perror("Store growth failed");
+        exit(EXIT_FAILURE);
+    }
+    long first_line = 1;
+    for (int i = 0; i < threads; i++) {
+        chunk_t *chunk = &chunks[i];
+        long r = 0;
+        for (long n = 0; n < chunk->num_rows; n++) {
+            // Parse errors and duplicates are reported in line order
+            while (r < chunk->num_rejects && chunk->rejects[r].line < chunk->row_lines[n]) {
+                reject_t *reject = &chunk->rejects[r++];
+                count_reason(stats, reject->reason);
+                report_reject(rejects, data, first_line + reject->line, reject->offset, reject->length, reject->reason);
+            }
+            if (store_insert(store, &chunk->rows[n]) != STORE_NOT_FOUND) {
+                stats->loaded++;
+            } else {
+                size_t offset = chunk->row_offsets[n];
+                count_reason(stats, duplicate_reason);
+                report_reject(rejects, data, first_line + chunk->row_lines[n], offset,
+                              line_length(data, size, offset), duplicate_reason);
+            }
+        }
+        for (; r < chunk->num_rejects; r++) {
+            reject_t *reject = &chunk->rejects[r];
+            count_reason(stats, reject->reason);
+            report_reject(rejects, data, first_line + reject->line, reject->offset, reject->length, reject->reason);
+        }
+        first_line += chunk->num_lines;
+
+        free(chunk->rows);
+        free(chunk->row_lines);
+        free(chunk->row_offsets);
+        free(chunk->rejects);
+    }
+
+    free(chunks);
+    free(ids);
+    munmap((void *)data, size);
+    return 0;
+}
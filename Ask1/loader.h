@@ -0,0 +1,27 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stdio.h>
+#include "store.h"
+
+// Bulk loader: maps a CSV manifest, validates it in parallel chunks (one
+// thread per chunk, split at line boundaries), then appends the valid rows
+// to a store presized for all of them. Rows whose code is already taken,
+// earlier in the file or in the store, are rejected as duplicates.
+
+#define LOADER_MAX_REASONS 16
+
+typedef struct load_stats {
+    long loaded;
+    long rejected;
+    int num_reasons;
+    const char *reasons[LOADER_MAX_REASONS];    // Rejections by reason
+    long reason_counts[LOADER_MAX_REASONS];
+} load_stats_t;
+
+// Load 'csv' into 'store' with 'threads' threads (0: one per core). Every
+// rejected row goes to 'rejects' as "line N: reason: row" unless it is NULL.
+// Returns 0, or -1 with errno set if the file cannot be read
+int load_csv(store_t *store, const char *csv, int threads, FILE *rejects, load_stats_t *stats);
+
+#endif // LOADER_H
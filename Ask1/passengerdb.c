@@ -0,0 +1,534 @@
+// Command line front end of the passenger store, used by processes_ipc.sh.
+//
+// passengerdb import <db> <csv> [rejects]
+//                                      build the store from a CSV file, validated in
+//                                      parallel; rejected rows are listed in 'rejects'
+// passengerdb add <db> <record> [csv]  validate and insert one record, appending it
+//                                      to 'csv' too
+// passengerdb get <db> <code|fullname> print the matching passengers
+// passengerdb update <db> <code|fullname> <field> <value>
+//                                      change one field of one passenger
+// passengerdb batch <db>               updates from stdin, one "key<TAB>field<TAB>value"
+//                                      per line, synced to disk once per batch
+// passengerdb export <db> <csv>        write the store back out as CSV
+// passengerdb reports <db>             percentages.txt and avg.txt from the running
+//                                      aggregates, in constant time
+// passengerdb verify <db>              check the aggregates against a full scan
+// passengerdb view <db> [-p page] [-n rows] [-c country] [-s status] [-r Yes|No]
+//                                      one page of passengers in aligned columns,
+//                                      filtered through the posting lists
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include "store.h"
+#include "loader.h"
+
+#define BATCH_SIZE 4096     // Updates per group commit
+#define PAGE_ROWS 20
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s import <db> <csv> [rejects]\n"
+                    "       %s add <db> <record> [csv]\n"
+                    "       %s get <db> <code|fullname>\n"
+                    "       %s update <db> <code|fullname> <field> <value>\n"
+                    "       %s batch <db>\n"
+                    "       %s export <db> <csv>\n"
+                    "       %s reports <db>\n"
+                    "       %s verify <db>\n"
+                    "       %s view <db> [-p page] [-n rows] [-c country] [-s status] [-r Yes|No]\n",
+            prog, prog, prog, prog, prog, prog, prog, prog, prog);
+}
+
+static int open_store(store_t *store, const char *path, int mode) {
+    if (store_open(store, path, mode) == -1) {
+        if (errno == EINVAL) {
+            fprintf(stderr, "Error: %s is not a store of this version, rebuild it with import.\n", path);
+        } else {
+            fprintf(stderr, "Error: cannot open store %s: %s\n", path, strerror(errno));
+        }
+        return -1;
+    }
+    return 0;
+}
+
+static void print_passenger(const passenger_t *p) {
+    printf("Code: %s\nFull Name: %s\nAge: %d\nCountry: %s\nStatus: %s\nRescued: %s\n\n",
+           p->code, p->fullname, p->age, p->country,
+           p->status == STATUS_CREW ? "Crew" : "Passenger", p->rescued ? "Yes" : "No");
+}
+
+// Give the CSV the store's timestamp
+static int stamp_csv(store_t *store, const char *csv) {
+    struct stat st;
+    if (fstat(store->fd, &st) == -1 || utimensat(AT_FDCWD, csv, (struct timespec[]){ st.st_atim, st.st_mtim }, 0) == -1) {
+        perror(csv);
+        return -1;
+    }
+    return 0;
+}
+
+// Whether the store has changes the CSV lacks (it was written after it)
+static int store_ahead(store_t *store, const char *csv) {
+    struct stat db_st, csv_st;
+    if (fstat(store->fd, &db_st) == -1 || stat(csv, &csv_st) == -1) return 0;
+    if (db_st.st_mtim.tv_sec != csv_st.st_mtim.tv_sec) return db_st.st_mtim.tv_sec > csv_st.st_mtim.tv_sec;
+    return db_st.st_mtim.tv_nsec > csv_st.st_mtim.tv_nsec;
+}
+
+// Streams the records through one large buffer into a temporary file that
+// then replaces the CSV, so readers never see a half-written manifest. The
+// CSV takes the store's timestamp, which processes_ipc.sh reads as "in step"
+static int write_csv(store_t *store, const char *csv) {
+    char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", csv);
+    FILE *out = fopen(tmp, "w");
+    if (!out) {
+        perror(tmp);
+        return -1;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+    char line[512];
+    long count = store_count(store);
+    for (long n = 0; n < count; n++) {
+        int length = passenger_format(store_record(store, n), line, sizeof(line) - 1);
+        line[length++] = '\n';
+        fwrite(line, 1, length, out);
+    }
+
+    if (fclose(out) != 0 || rename(tmp, csv) == -1) {
+        perror(csv);
+        unlink(tmp);
+        return -1;
+    }
+    return stamp_csv(store, csv);
+}
+
+static int cmd_export(const char *db, const char *csv) {
+    store_t store;
+    if (open_store(&store, db, STORE_READ) == -1) return EXIT_FAILURE;
+    int status = write_csv(&store, csv) == -1 ? EXIT_FAILURE : 0;
+    store_close(&store);
+    return status;
+}
+
+// Rebuilds an existing store in place, so the exclusive lock is held from
+// writing its pending updates back to the CSV until the reload is done and
+// no update can slip in between
+static int cmd_import(const char *db, const char *csv, const char *rejects_path) {
+    FILE *rejects = NULL;
+    if (rejects_path && !(rejects = fopen(rejects_path, "w"))) {
+        perror(rejects_path);
+        return EXIT_FAILURE;
+    }
+    if (rejects) setvbuf(rejects, NULL, _IOFBF, 1 << 20);
+
+    store_t store;
+    if (store_open(&store, db, STORE_WRITE) == 0) {
+        if (store_ahead(&store, csv) && write_csv(&store, csv) == -1) {
+            store_close(&store);
+            return EXIT_FAILURE;
+        }
+        if (store_clear(&store) == -1) {
+            perror(db);
+            return EXIT_FAILURE;
+        }
+    } else if (open_store(&store, db, STORE_CREATE) == -1) {
+        return EXIT_FAILURE;
+    }
+
+    // A missing file loads as an empty manifest
+    load_stats_t stats;
+    if (load_csv(&store, csv, 0, rejects, &stats) == -1 && errno != ENOENT) {
+        perror(csv);
+        store_close(&store);
+        return EXIT_FAILURE;
+    }
+    // Same timestamp as the file: the store is neither stale nor ahead of it
+    struct stat st;
+    if (stat(csv, &st) == 0) futimens(store.fd, (struct timespec[]){ st.st_atim, st.st_mtim });
+    store_close(&store);
+    if (rejects) fclose(rejects);
+
+    printf("Loaded %ld passengers into %s (%ld rows rejected).\n", stats.loaded, db, stats.rejected);
+    for (int i = 0; i < stats.num_reasons; i++) {
+        printf("  %ld: %s\n", stats.reason_counts[i], stats.reasons[i]);
+    }
+    return 0;
+}
+
+// With a CSV, the record is also appended to it under the store's lock,
+// after any updates the CSV lacks have been written back
+static int cmd_add(const char *db, const char *record, const char *csv) {
+    passenger_t passenger;
+    const char *error;
+    if (passenger_parse(record, strlen(record), &passenger, &error) != 0) {
+        printf("Invalid format: %s.\n", error);
+        return EXIT_FAILURE;
+    }
+
+    store_t store;
+    if (open_store(&store, db, STORE_WRITE) == -1) return EXIT_FAILURE;
+    if (csv && store_ahead(&store, csv) && write_csv(&store, csv) == -1) {
+        store_close(&store);
+        return EXIT_FAILURE;
+    }
+    long n = store_insert(&store, &passenger);
+    if (n == STORE_NOT_FOUND) {
+        store_close(&store);
+        printf("A passenger with code %s already exists.\n", passenger.code);
+        return EXIT_FAILURE;
+    }
+
+    int status = 0;
+    if (csv) {
+        char line[512];
+        int length = passenger_format(&passenger, line, sizeof(line) - 1);
+        line[length++] = '\n';
+        FILE *out = fopen(csv, "a");
+        if (!out || fwrite(line, 1, length, out) != (size_t)length || fclose(out) != 0) {
+            perror(csv);
+            status = EXIT_FAILURE;
+        } else if (stamp_csv(&store, csv) == -1) {
+            status = EXIT_FAILURE;
+        }
+    }
+    store_close(&store);
+    return status;
+}
+
+// Same matching as the old awk scan: the code, or the full name ignoring case
+static int cmd_get(const char *db, const char *key) {
+    store_t store;
+    if (open_store(&store, db, STORE_READ) == -1) return EXIT_FAILURE;
+
+    int found = 0;
+    long n = store_find_code(&store, key);
+    if (n != STORE_NOT_FOUND) {
+        print_passenger(store_record(&store, n));
+        found++;
+    }
+    uint64_t cursor = 0;
+    long by_code = n;
+    while ((n = store_next_by_name(&store, key, &cursor)) != STORE_NOT_FOUND) {
+        if (n == by_code) continue;
+        print_passenger(store_record(&store, n));
+        found++;
+    }
+    store_close(&store);
+
+    if (!found) {
+        printf("No passenger found with the code/fullname '%s'!\n", key);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+// The one passenger a key names: the code, or else a full name that only one
+// passenger has. Prints why not and returns STORE_NOT_FOUND otherwise
+static long resolve_key(store_t *store, const char *key) {
+    long n = store_find_code(store, key);
+    if (n != STORE_NOT_FOUND) return n;
+
+    uint64_t cursor = 0;
+    n = store_next_by_name(store, key, &cursor);
+    if (n == STORE_NOT_FOUND) {
+        printf("No passenger found with the code/fullname '%s'!\n", key);
+        return STORE_NOT_FOUND;
+    }
+    if (store_next_by_name(store, key, &cursor) != STORE_NOT_FOUND) {
+        printf("More than one passenger is named '%s', use the code.\n", key);
+        return STORE_NOT_FOUND;
+    }
+    return n;
+}
+
+static int apply_update(store_t *store, const char *key, const char *field, const char *value) {
+    long n = resolve_key(store, key);
+    if (n == STORE_NOT_FOUND) return -1;
+
+    passenger_t passenger = *store_record(store, n);
+    const char *error;
+    if (passenger_set_field(&passenger, field, value, &error) != 0) {
+        printf("Invalid %s: %s.\n", field, error);
+        return -1;
+    }
+    if (store_update(store, n, &passenger) != 0) {
+        printf("A passenger with code %s already exists.\n", passenger.code);
+        return -1;
+    }
+    return 0;
+}
+
+static int cmd_update(const char *db, const char *key, const char *field, const char *value) {
+    store_t store;
+    if (open_store(&store, db, STORE_WRITE) == -1) return EXIT_FAILURE;
+
+    int status = apply_update(&store, key, field, value) == 0 ? 0 : EXIT_FAILURE;
+    if (status == 0 && store_sync(&store) == -1) {
+        perror("msync");
+        status = EXIT_FAILURE;
+    }
+    store_close(&store);
+    if (status == 0) printf("Passenger '%s' updated.\n", key);
+    return status;
+}
+
+// Group commit: the records change in memory and reach the disk with one
+// msync per BATCH_SIZE updates instead of one per update
+static int cmd_batch(const char *db) {
+    store_t store;
+    if (open_store(&store, db, STORE_WRITE) == -1) return EXIT_FAILURE;
+
+    long applied = 0, failed = 0, pending = 0;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t length;
+    while ((length = getline(&line, &size, stdin)) != -1) {
+        if (length > 0 && line[length - 1] == '\n') line[--length] = '\0';
+        if (length == 0) continue;
+
+        char *field = strchr(line, '\t');
+        char *value = field ? strchr(field + 1, '\t') : NULL;
+        if (!value) {
+            printf("Invalid update '%s': expected key<TAB>field<TAB>value.\n", line);
+            failed++;
+            continue;
+        }
+        *field++ = '\0';
+        *value++ = '\0';
+
+        if (apply_update(&store, line, field, value) == 0) {
+            applied++;
+            if (++pending == BATCH_SIZE) {
+                store_sync(&store);
+                pending = 0;
+            }
+        } else {
+            failed++;
+        }
+    }
+    free(line);
+
+    int status = 0;
+    if (pending > 0 && store_sync(&store) == -1) {
+        perror("msync");
+        status = EXIT_FAILURE;
+    }
+    store_close(&store);
+
+    printf("Applied %ld updates (%ld failed).\n", applied, failed);
+    return failed > 0 ? EXIT_FAILURE : status;
+}
+
+// Same formats as the reports program, but from the counters in the header
+static int cmd_reports(const char *db) {
+    store_t store;
+    if (open_store(&store, db, STORE_READ) == -1) return EXIT_FAILURE;
+    store_stats_t stats = store.header->stats;
+    store_close(&store);
+
+    FILE *percentages = fopen("percentages.txt", "w");
+    FILE *avg = fopen("avg.txt", "w");
+    if (!percentages || !avg) {
+        perror("fopen");
+        return EXIT_FAILURE;
+    }
+    fprintf(percentages, "Percentages of rescued:\n");
+    for (int g = 0; g < NUM_AGE_GROUPS; g++) {
+        if (stats.group_total[g] > 0) {
+            fprintf(percentages, "ages %s: %.2f%%\n", age_group_names[g],
+                    100.0 * stats.group_rescued[g] / stats.group_total[g]);
+        }
+    }
+    fprintf(avg, "Average age per passenger status:\n");
+    for (int s = 0; s < NUM_STATUSES; s++) {
+        if (stats.status_count[s] > 0) {
+            fprintf(avg, "%s: %.2f\n", status_names[s], (double)stats.status_age_sum[s] / stats.status_count[s]);
+        }
+    }
+    fclose(percentages);
+    fclose(avg);
+    return 0;
+}
+
+static int cmd_verify(const char *db) {
+    store_t store;
+    if (open_store(&store, db, STORE_READ) == -1) return EXIT_FAILURE;
+    store_stats_t scanned;
+    store_recompute_stats(&store, &scanned);
+    store_stats_t *kept = &store.header->stats;
+    long count = store_count(&store);
+
+    int mismatches = 0;
+    for (int g = 0; g < NUM_AGE_GROUPS; g++) {
+        if (kept->group_total[g] != scanned.group_total[g] || kept->group_rescued[g] != scanned.group_rescued[g]) {
+            printf("ages %s: kept %lu/%lu rescued, scanned %lu/%lu\n", age_group_names[g],
+                   (unsigned long)kept->group_rescued[g], (unsigned long)kept->group_total[g],
+                   (unsigned long)scanned.group_rescued[g], (unsigned long)scanned.group_total[g]);
+            mismatches++;
+        }
+    }
+    for (int s = 0; s < NUM_STATUSES; s++) {
+        if (kept->status_count[s] != scanned.status_count[s] || kept->status_age_sum[s] != scanned.status_age_sum[s]) {
+            printf("%s: kept %lu ages summing to %lu, scanned %lu summing to %lu\n", status_names[s],
+                   (unsigned long)kept->status_count[s], (unsigned long)kept->status_age_sum[s],
+                   (unsigned long)scanned.status_count[s], (unsigned long)scanned.status_age_sum[s]);
+            mismatches++;
+        }
+    }
+    store_close(&store);
+
+    if (mismatches > 0) return EXIT_FAILURE;
+    printf("Aggregates match a full scan of %ld records.\n", count);
+    return 0;
+}
+
+typedef struct view_filter {
+    const char *keys[NUM_LIST_KINDS];       // NULL when not filtered on
+} view_filter_t;
+
+static int view_matches(const view_filter_t *filter, const passenger_t *p) {
+    const char *values[NUM_LIST_KINDS] = { status_names[p->status], p->rescued ? "Yes" : "No", p->country };
+    for (int kind = 0; kind < NUM_LIST_KINDS; kind++) {
+        if (filter->keys[kind] && strcasecmp(filter->keys[kind], values[kind]) != 0) return 0;
+    }
+    return 1;
+}
+
+static void print_page(store_t *store, const long *rows, long num_rows) {
+    int code_width = 4, name_width = 9, country_width = 7;
+    for (long i = 0; i < num_rows; i++) {
+        const passenger_t *p = store_record(store, rows[i]);
+        int length;
+        if ((length = strlen(p->code)) > code_width) code_width = length;
+        if ((length = strlen(p->fullname)) > name_width) name_width = length;
+        if ((length = strlen(p->country)) > country_width) country_width = length;
+    }
+
+    printf("%-*s  %-*s  %3s  %-*s  %-9s  %s\n", code_width, "Code", name_width, "Full Name", "Age",
+           country_width, "Country", "Status", "Rescued");
+    for (long i = 0; i < num_rows; i++) {
+        const passenger_t *p = store_record(store, rows[i]);
+        printf("%-*s  %-*s  %3d  %-*s  %-9s  %s\n", code_width, p->code, name_width, p->fullname, p->age,
+               country_width, p->country, status_names[p->status], p->rescued ? "Yes" : "No");
+    }
+}
+
+// A page costs what it shows: with no filter or one filter it is read
+// straight out of the records or that filter's posting list. Several filters
+// walk the shortest of their lists, never the whole store
+static int cmd_view(int argc, char *argv[]) {
+    const char *db = argv[1];
+    long page = 1, page_rows = PAGE_ROWS;
+    view_filter_t filter = { { NULL } };
+
+    int opt;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "p:n:c:s:r:")) != -1) {
+        switch (opt) {
+        case 'p': page = atol(optarg); break;
+        case 'n': page_rows = atol(optarg); break;
+        case 'c': filter.keys[LIST_COUNTRY] = optarg; break;
+        case 's': filter.keys[LIST_STATUS] = optarg; break;
+        case 'r': filter.keys[LIST_RESCUED] = optarg; break;
+        default:
+            usage("passengerdb");
+            return EXIT_FAILURE;
+        }
+    }
+    if (page <= 0 || page_rows <= 0) {
+        fprintf(stderr, "Error: page and rows must be positive.\n");
+        return EXIT_FAILURE;
+    }
+
+    store_t store;
+    if (open_store(&store, db, STORE_READ) == -1) return EXIT_FAILURE;
+
+    // The driving list: the shortest one among the filters, or every record
+    const posting_list_t *driver = NULL;
+    long driver_count = store_count(&store);
+    int num_filters = 0, scan = 0;
+    for (int kind = 0; kind < NUM_LIST_KINDS; kind++) {
+        if (!filter.keys[kind]) continue;
+        num_filters++;
+        posting_list_t *list = postings_find(&store.postings, kind, filter.keys[kind]);
+        if (!list) {
+            // A full directory leaves some countries unlisted: those are scanned for
+            if (kind == LIST_COUNTRY && store.postings.header->overflow) {
+                scan = 1;
+                continue;
+            }
+            driver_count = 0;
+            driver = NULL;
+            break;
+        }
+        if (!driver || (long)list->count < driver_count) {
+            driver = list;
+            driver_count = list->count;
+        }
+    }
+
+    long first = (page - 1) * page_rows;
+    long *rows = malloc(sizeof(long) * page_rows);
+    if (!rows) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    long num_rows = 0, total;
+    postings_cursor_t cursor;
+
+    if (num_filters <= 1 && !scan) {
+        total = driver_count;
+        if (driver) postings_seek(&store.postings, driver, first, &cursor);
+        for (long i = first; i < total && num_rows < page_rows; i++) {
+            rows[num_rows++] = driver ? postings_next(&cursor) : i;
+        }
+    } else {
+        total = 0;
+        if (driver) postings_seek(&store.postings, driver, 0, &cursor);
+        for (long i = 0; i < driver_count; i++) {
+            long n = driver ? postings_next(&cursor) : i;
+            if (!view_matches(&filter, store_record(&store, n))) continue;
+            if (total >= first && num_rows < page_rows) rows[num_rows++] = n;
+            total++;
+        }
+    }
+
+    long pages = (total + page_rows - 1) / page_rows;
+    if (num_rows > 0) {
+        print_page(&store, rows, num_rows);
+        printf("\nPage %ld of %ld (%ld passengers)\n", page, pages, total);
+    } else if (total == 0) {
+        printf("No passengers to show.\n");
+    } else {
+        printf("Page %ld is past the end (%ld pages).\n", page, pages);
+    }
+    free(rows);
+    store_close(&store);
+    return num_rows > 0 ? 0 : EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[]) {
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "import") == 0) {
+        return cmd_import(argv[2], argv[3], argc == 5 ? argv[4] : NULL);
+    }
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "add") == 0) {
+        return cmd_add(argv[2], argv[3], argc == 5 ? argv[4] : NULL);
+    }
+    if (argc == 4 && strcmp(argv[1], "get") == 0) return cmd_get(argv[2], argv[3]);
+    if (argc == 6 && strcmp(argv[1], "update") == 0) return cmd_update(argv[2], argv[3], argv[4], argv[5]);
+    if (argc == 3 && strcmp(argv[1], "batch") == 0) return cmd_batch(argv[2]);
+    if (argc == 4 && strcmp(argv[1], "export") == 0) return cmd_export(argv[2], argv[3]);
+    if (argc == 3 && strcmp(argv[1], "reports") == 0) return cmd_reports(argv[2]);
+    if (argc == 3 && strcmp(argv[1], "verify") == 0) return cmd_verify(argv[2]);
+    if (argc >= 3 && strcmp(argv[1], "view") == 0) return cmd_view(argc - 1, argv + 1);
+
+    usage(argv[0]);
+    return EXIT_FAILURE;
+}
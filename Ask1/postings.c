@@ -0,0 +1,295 @@
+#include "postings.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define ENTRY_WORDS (sizeof(posting_block_t) / sizeof(uint32_t))
+#define INITIAL_TABLE_ENTRIES (POSTINGS_BLOCK_ITEMS / ENTRY_WORDS)   // One block's worth
+#define HEADER_WORDS (((sizeof(postings_header_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t) \
+                      + POSTINGS_BLOCK_ITEMS - 1) / POSTINGS_BLOCK_ITEMS * POSTINGS_BLOCK_ITEMS)
+
+static int map_file(postings_t *postings, size_t size) {
+    int prot = postings->writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *addr = mmap(NULL, size, prot, MAP_SHARED, postings->fd, 0);
+    if (addr == MAP_FAILED) return -1;
+    postings->header = addr;
+    postings->words = addr;
+    postings->map_size = size;
+    return 0;
+}
+
+// Make room for 'words' more words at the end of the file: a whole number
+// of blocks, so everything allocated stays block-aligned
+static uint64_t allocate(postings_t *postings, uint64_t words) {
+    uint64_t offset = postings->header->end;
+    size_t size = (offset + words) * sizeof(uint32_t);
+
+    if (size > postings->map_size) {
+        size_t grown = postings->map_size * 2;
+        while (grown < size) grown *= 2;
+        munmap(postings->header, postings->map_size);
+        if (ftruncate(postings->fd, grown) == -1 || map_file(postings, grown) == -1) {
+            perror("Posting lists growth failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    postings->header->end = offset + words;
+    return offset;
+}
+
+// A block for items: a released one if there is one, else fresh space
+static uint64_t allocate_block(postings_t *postings) {
+    uint64_t offset = postings->header->free_block;
+    if (offset == 0) return allocate(postings, POSTINGS_BLOCK_ITEMS);
+    memcpy(&postings->header->free_block, postings->words + offset, sizeof(uint64_t));
+    return offset;
+}
+
+static void release_block(postings_t *postings, uint64_t offset) {
+    memcpy(postings->words + offset, &postings->header->free_block, sizeof(uint64_t));
+    postings->header->free_block = offset;
+}
+
+static posting_block_t *block_table(postings_t *postings, const posting_list_t *list) {
+    return (posting_block_t *)(postings->words + list->table);
+}
+
+int postings_open(postings_t *postings, const char *path, int writable, int create) {
+    memset(postings, 0, sizeof(*postings));
+    postings->writable = writable;
+    postings->fd = open(path, writable ? O_RDWR | (create ? O_CREAT : 0) : O_RDONLY, 0644);
+    if (postings->fd == -1) return -1;
+
+    if (create) {
+        size_t size = HEADER_WORDS * sizeof(uint32_t) * 2;
+        if (ftruncate(postings->fd, 0) == -1 || ftruncate(postings->fd, size) == -1
+            || map_file(postings, size) == -1) {
+            goto fail;
+        }
+        postings->header->magic = POSTINGS_MAGIC;
+        postings->header->end = HEADER_WORDS;
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(postings->fd, &st) == -1) goto fail;
+    if ((size_t)st.st_size < sizeof(postings_header_t)) {
+        errno = EINVAL;
+        goto fail;
+    }
+    if (map_file(postings, st.st_size) == -1) goto fail;
+    if (postings->header->magic != POSTINGS_MAGIC || postings->header->end * sizeof(uint32_t) > (size_t)st.st_size) {
+        munmap(postings->header, postings->map_size);
+        errno = EINVAL;
+        goto fail;
+    }
+    return 0;
+
+fail:
+    {
+        int saved = errno;
+        close(postings->fd);
+        errno = saved;
+    }
+    return -1;
+}
+
+void postings_close(postings_t *postings) {
+    munmap(postings->header, postings->map_size);
+    close(postings->fd);
+}
+
+int postings_sync(postings_t *postings) {
+    return msync(postings->header, postings->map_size, MS_SYNC);
+}
+
+static uint64_t hash_key(int kind, const char *key) {
+    uint64_t hash = 14695981039346656037ull ^ (uint64_t)kind;  // FNV-1a, case-folded
+    for (; *key; key++) {
+        hash = (hash ^ (unsigned char)tolower((unsigned char)*key)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// The directory slot of a kind and key: its list, or the empty slot it would take
+static uint16_t *table_slot(postings_header_t *header, int kind, const char *key) {
+    uint64_t mask = POSTINGS_TABLE_SLOTS - 1;
+    for (uint64_t i = hash_key(kind, key) & mask;; i = (i + 1) & mask) {
+        uint16_t entry = header->table[i];
+        if (entry == 0) return &header->table[i];
+        posting_list_t *list = &header->lists[entry - 1];
+        if (list->kind == (uint32_t)kind && strcasecmp(list->key, key) == 0) return &header->table[i];
+    }
+}
+
+posting_list_t *postings_find(postings_t *postings, int kind, const char *key) {
+    uint16_t entry = *table_slot(postings->header, kind, key);
+    return entry ? &postings->header->lists[entry - 1] : NULL;
+}
+
+// The list for a key, created empty on first use. NULL if the directory is full
+static posting_list_t *get_list(postings_t *postings, int kind, const char *key) {
+    posting_list_t *list = postings_find(postings, kind, key);
+    if (list) return list;
+
+    postings_header_t *header = postings->header;
+    if (header->num_lists == MAX_POSTING_LISTS) {
+        header->overflow = 1;
+        return NULL;
+    }
+    uint64_t table = allocate(postings, INITIAL_TABLE_ENTRIES * ENTRY_WORDS);
+    header = postings->header;
+    *table_slot(header, kind, key) = header->num_lists + 1;
+    list = &header->lists[header->num_lists++];
+    memset(list, 0, sizeof(*list));
+    snprintf(list->key, sizeof(list->key), "%s", key);
+    list->kind = kind;
+    list->table_capacity = INITIAL_TABLE_ENTRIES;
+    list->table = table;
+    return list;
+}
+
+// Put a block into list 'index''s table at position 'at'
+static void table_insert(postings_t *postings, size_t index, uint64_t at, posting_block_t entry) {
+    posting_list_t *list = &postings->header->lists[index];
+
+    if (list->blocks == list->table_capacity) {
+        // The table moves to the end of the file; its old blocks are released
+        uint64_t offset = allocate(postings, list->table_capacity * 2 * ENTRY_WORDS);
+        list = &postings->header->lists[index];
+        memcpy(postings->words + offset, postings->words + list->table, list->blocks * sizeof(posting_block_t));
+        for (uint64_t i = 0; i < list->table_capacity * ENTRY_WORDS; i += POSTINGS_BLOCK_ITEMS) {
+            release_block(postings, list->table + i);
+        }
+        list->table = offset;
+        list->table_capacity *= 2;
+    }
+
+    posting_block_t *table = block_table(postings, list);
+    memmove(table + at + 1, table + at, (list->blocks - at) * sizeof(posting_block_t));
+    table[at] = entry;
+    list->blocks++;
+}
+
+// The block n belongs in: the last one starting at or before n, else the first
+static uint64_t find_block(const posting_block_t *table, uint64_t blocks, uint32_t n) {
+    uint64_t low = 0, high = blocks;
+    while (low < high) {
+        uint64_t mid = (low + high) / 2;
+        if (table[mid].first <= n) low = mid + 1;
+        else high = mid;
+    }
+    return low > 0 ? low - 1 : 0;
+}
+
+// First position in the block whose item is >= n
+static uint64_t lower_bound(const uint32_t *items, uint64_t count, uint32_t n) {
+    uint64_t low = 0, high = count;
+    while (low < high) {
+        uint64_t mid = (low + high) / 2;
+        if (items[mid] < n) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static void list_insert(postings_t *postings, int kind, const char *key, uint32_t n) {
+    posting_list_t *list = get_list(postings, kind, key);
+    if (!list) return;
+    size_t index = list - postings->header->lists;
+
+    if (list->blocks == 0) {
+        uint64_t offset = allocate_block(postings);
+        table_insert(postings, index, 0, (posting_block_t){ n, 0, offset });
+        list = &postings->header->lists[index];
+    }
+
+    posting_block_t *table = block_table(postings, list);
+    uint64_t b = find_block(table, list->blocks, n);
+    if (table[b].count == POSTINGS_BLOCK_ITEMS) {
+        // Past the block's last item (an import appends) n starts a new block;
+        // anywhere else the block is split in two
+        uint32_t keep = postings->words[table[b].offset + POSTINGS_BLOCK_ITEMS - 1] < n
+                      ? POSTINGS_BLOCK_ITEMS : POSTINGS_BLOCK_ITEMS / 2;
+        uint32_t moved = POSTINGS_BLOCK_ITEMS - keep;
+        uint64_t offset = allocate_block(postings);
+        list = &postings->header->lists[index];
+        table = block_table(postings, list);
+        uint32_t *items = postings->words + table[b].offset;
+
+        memcpy(postings->words + offset, items + keep, moved * sizeof(uint32_t));
+        table[b].count = keep;
+        table_insert(postings, index, b + 1, (posting_block_t){ moved ? items[keep] : n, moved, offset });
+        list = &postings->header->lists[index];
+        table = block_table(postings, list);
+        if (moved == 0 || n >= table[b + 1].first) b++;
+    }
+
+    uint32_t *items = postings->words + table[b].offset;
+    uint64_t count = table[b].count;
+    uint64_t at = count > 0 && items[count - 1] > n ? lower_bound(items, count, n) : count;
+    memmove(items + at + 1, items + at, (count - at) * sizeof(uint32_t));
+    items[at] = n;
+    table[b].count++;
+    table[b].first = items[0];
+    list->count++;
+}
+
+static void list_remove(postings_t *postings, int kind, const char *key, uint32_t n) {
+    posting_list_t *list = postings_find(postings, kind, key);
+    if (!list || list->blocks == 0) return;
+
+    posting_block_t *table = block_table(postings, list);
+    uint64_t b = find_block(table, list->blocks, n);
+    uint32_t *items = postings->words + table[b].offset;
+    uint64_t count = table[b].count;
+    uint64_t at = lower_bound(items, count, n);
+    if (at == count || items[at] != n) return;
+
+    memmove(items + at, items + at + 1, (count - at - 1) * sizeof(uint32_t));
+    list->count--;
+    if (--table[b].count > 0) {
+        table[b].first = items[0];
+        return;
+    }
+
+    // An emptied block leaves the table and is reused by the next split
+    release_block(postings, table[b].offset);
+    memmove(table + b, table + b + 1, (list->blocks - b - 1) * sizeof(posting_block_t));
+    list->blocks--;
+}
+
+void postings_add(postings_t *postings, const char *keys[NUM_LIST_KINDS], uint32_t n) {
+    for (int kind = 0; kind < NUM_LIST_KINDS; kind++) {
+        list_insert(postings, kind, keys[kind], n);
+    }
+}
+
+void postings_move(postings_t *postings, const char *old_keys[NUM_LIST_KINDS],
+                   const char *keys[NUM_LIST_KINDS], uint32_t n) {
+    for (int kind = 0; kind < NUM_LIST_KINDS; kind++) {
+        if (strcasecmp(old_keys[kind], keys[kind]) != 0) {
+            list_remove(postings, kind, old_keys[kind], n);
+            list_insert(postings, kind, keys[kind], n);
+        }
+    }
+}
+
+void postings_seek(postings_t *postings, const posting_list_t *list, uint64_t position,
+                   postings_cursor_t *cursor) {
+    cursor->words = postings->words;
+    cursor->table = block_table(postings, list);
+    cursor->blocks = list->blocks;
+    cursor->block = 0;
+    while (cursor->block < cursor->blocks && position >= cursor->table[cursor->block].count) {
+        position -= cursor->table[cursor->block++].count;
+    }
+    cursor->at = position;
+}
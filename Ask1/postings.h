@@ -0,0 +1,100 @@
+#ifndef POSTINGS_H
+#define POSTINGS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Posting lists of the passenger store (<manifest>.db.lists): for every
+// status, rescued value and country, the sorted numbers of the records that
+// have it. A filtered view reads its page straight out of a list, so page N
+// of "Crew" costs the same as page 1.
+//
+// The file starts with a directory of lists. Each list is a run of blocks of
+// one page each, in item order, found through the list's block table. An
+// update moves a record between two lists by editing one block of each, so
+// it dirties a few pages however long the lists are. A full block is split
+// in two; an emptied one is released for reuse. Everything past the
+// directory is allocated in whole blocks, so blocks stay page-aligned.
+// An import writes the file from scratch, which compacts it.
+
+#define POSTINGS_MAGIC 0x42534c50u  // "PLSB"
+#define POSTINGS_KEY_LEN 40         // COUNTRY_LEN
+#define MAX_POSTING_LISTS 1024
+#define POSTINGS_TABLE_SLOTS 2048   // Hash table over the directory: list index + 1, 0 when empty
+#define POSTINGS_BLOCK_ITEMS 1024   // Items per block: 4 KiB
+
+enum { LIST_STATUS, LIST_RESCUED, LIST_COUNTRY, NUM_LIST_KINDS };
+
+// An entry of a list's block table
+typedef struct posting_block {
+    uint32_t first;                 // Smallest item of the block
+    uint32_t count;
+    uint64_t offset;                // Items, in uint32_t units from the start of the file
+} posting_block_t;
+
+typedef struct posting_list {
+    char key[POSTINGS_KEY_LEN];     // Compared ignoring case
+    uint32_t kind;
+    uint32_t pad;
+    uint64_t count;                 // Items in all blocks
+    uint64_t blocks;                // Blocks in use
+    uint64_t table_capacity;        // Entries the block table has room for
+    uint64_t table;                 // Block table, in uint32_t units from the start of the file
+} posting_list_t;
+
+typedef struct postings_header {
+    uint32_t magic;
+    uint32_t num_lists;
+    uint64_t end;                   // Words in use; the file may be larger
+    uint32_t overflow;              // Set once a country found the directory full
+    uint32_t reserved;
+    uint64_t free_block;            // First released block (each holds the next), 0 if none
+    uint16_t table[POSTINGS_TABLE_SLOTS];
+    posting_list_t lists[MAX_POSTING_LISTS];
+} postings_header_t;
+
+typedef struct postings {
+    int fd;
+    int writable;
+    postings_header_t *header;
+    uint32_t *words;                // The whole file, header included
+    size_t map_size;
+} postings_t;
+
+// Reads a list in order from a given position
+typedef struct postings_cursor {
+    const uint32_t *words;
+    const posting_block_t *table;
+    uint64_t blocks, block, at;     // Next item: item 'at' of block 'block'
+} postings_cursor_t;
+
+// Called by the store with its lock held. Returns 0, or -1 with errno set
+int postings_open(postings_t *postings, const char *path, int writable, int create);
+void postings_close(postings_t *postings);
+int postings_sync(postings_t *postings);
+
+// Add record n under keys[], indexed by kind (insert), or move it there
+// from old_keys[] (update)
+void postings_add(postings_t *postings, const char *keys[NUM_LIST_KINDS], uint32_t n);
+void postings_move(postings_t *postings, const char *old_keys[NUM_LIST_KINDS],
+                   const char *keys[NUM_LIST_KINDS], uint32_t n);
+
+// The list of a kind and key, or NULL when no record has it
+posting_list_t *postings_find(postings_t *postings, int kind, const char *key);
+
+// Start reading 'list' at its item 'position'. The cursor only reads the
+// block table up to that item, not the blocks before it
+void postings_seek(postings_t *postings, const posting_list_t *list, uint64_t position,
+                   postings_cursor_t *cursor);
+
+// The next item, or -1 past the end of the list
+static inline long postings_next(postings_cursor_t *cursor) {
+    while (cursor->block < cursor->blocks && cursor->at == cursor->table[cursor->block].count) {
+        cursor->block++;
+        cursor->at = 0;
+    }
+    if (cursor->block == cursor->blocks) return -1;
+    return cursor->words[cursor->table[cursor->block].offset + cursor->at++];
+}
+
+#endif // POSTINGS_H
@@ -1,5 +1,42 @@
 #!/bin/bash
 
+# Compiled helpers are built next to this script with make
+tools_dir=$(dirname "$0")
+
+# Check that a compiled helper exists
+require_tool() {
+    if [[ ! -x "$tools_dir/$1" ]]; then
+        echo "Error: $tools_dir/$1 not found, run make in $tools_dir first."
+        return 1
+    fi
+}
+
+# Bulk load the file into the indexed store; rejected rows go to $filename.rejects.
+# Updates the store holds are written back to the file first, under the same
+# lock as the reload, and the store ends up with the file's timestamp
+load_store() {
+    db="$filename.db"
+    require_tool passengerdb || return 1
+    "$tools_dir/passengerdb" import "$db" "$filename" "$filename.rejects"
+}
+
+# Build the indexed store ($filename.db) when it is missing or older than the file
+ensure_store() {
+    db="$filename.db"
+    require_tool passengerdb || return 1
+    if [[ ! -f $db || $filename -nt $db ]]; then
+        load_store > /dev/null
+    fi
+}
+
+# Rewrite the file from the store when the store has changes it lacks (updates)
+ensure_csv() {
+    db="$filename.db"
+    if [[ -f $db && $db -nt $filename ]]; then
+        "$tools_dir/passengerdb" export "$db" "$filename" || return 1
+    fi
+}
+
 # Function to insert data into passengers.csv
 insert_data() {
     read -p "Enter the filename (including path) to read data from (leave empty for manual entry): " filename
@@ -16,24 +53,25 @@ insert_data() {
         if [[ ! -f passengers.csv ]]; then
             touch passengers.csv
         fi
+        ensure_store || return
 
         while true; do
             read -p "Enter data: " data
             if [[ $data == "done" ]]; then
                 break
             fi
-            #validate data format
-            if [[ $data =~ ^[0-9]+,.*,[0-9]+,.*,(Passenger|Crew),(Yes|No)$ ]]; then
-                echo "$data" >> passengers.csv
-            else
-                echo "Invalid format. Please try again."
+            #validate data format and index the record; passengerdb appends it to the CSV
+            #under the store's lock, after writing back any updates the CSV lacks
+            if ! "$tools_dir/passengerdb" add "$db" "$data" passengers.csv; then
+                echo "Please try again."
             fi
         done
         echo "Data saved to passengers.csv"
     else
         if [[ -f $filename ]]; then
             echo
-            echo "Data loaded successfully from $filename."
+            load_store || return
+            echo "Data loaded successfully from $filename (rejected rows in $filename.rejects)."
         else
             echo "File $filename not found. Please try again."
             insert_data #Recursive call for manual entry if file is invalid
@@ -54,60 +92,31 @@ search_passenger() {
         return
     fi
 
-    # Use grep to find the matching rows
-    #results=$(grep -i "\b$name\b" $filename)
-    results=$(awk -F'[;,]' -v name="$name" 'BEGIN {IGNORECASE = 1} ($1 == name || $2 == name) {print $0}' "$filename")
-
-    if [[ -z $results ]]; then
-        echo "No passenger found with the code/fullname '$name'!"
-    else
+    # Indexed lookup by code or (case-insensitive) fullname
+    ensure_store || return
+    if results=$("$tools_dir/passengerdb" get "$db" "$name"); then
         echo
         echo "Passenger details:"
-        echo "$results" | awk -F'[;,]' '{printf "Code: %s\nFull Name: %s\nAge: %s\nCountry: %s\nStatus: %s\nRescued: %s\n\n", $1, $2, $3, $4, $5, $6}'
     fi
+    echo "$results"
 }
 
 update_passenger() {
-    results=$(awk -F'[;,]' -v name="$argname" 'BEGIN {IGNORECASE = 1} ($1 == name || $2 == name) {print $0}' "$filename")
-
-    if [[ -z $results ]]; then
+    ensure_store || return
+    if ! results=$("$tools_dir/passengerdb" get "$db" "$argname"); then
         echo "No passenger found with the identifier '$argname'."
         return
     fi
 
     echo "Passenger found:"
-    echo "$results" | awk -F'[;,]' '{printf "Code: %s\nFull Name: %s\nAge: %s\nCountry: %s\nStatus: %s\nRescued: %s\n\n", $1, $2, $3, $4, $5, $6}'
-
-    case $selectedField in
-        fullname)
-            sed -i '' "/^$argname[;,]/ s/\([^;,]*[;,]\)[^;,]*/\1$argnewdata/" "$filename"
-            ;;
-        age)
-            sed -i '' "/^$argname[;,]/ s/\([^;,]*[;,][^;,]*[;,]\)[^;,]*/\1$argnewdata/" "$filename"
-            ;;
-        country)
-            sed -i '' "/^$argname[;,]/ s/\([^;,]*[;,][^;,]*[;,][^;,]*[;,]\)[^;,]*/\1$argnewdata/" "$filename"
-            ;;
-        status)
-            sed -i '' "/^$argname[;,]/ s/\([^;,]*[;,][^;,]*[;,][^;,]*[;,][^;,]*[;,]\)[^;,]*/\1$argnewdata/" "$filename"
-            ;;
-        rescued)
-            sed -i '' "/^$argname[;,]/ s/\([^;,]*[;,][^;,]*[;,][^;,]*[;,][^;,]*[;,][^;,]*[;,]\)[^;,]*/\1$argnewdata/" "$filename"
-            ;;
-        record)
-            if [[ $argnewdata =~  ^[0-9]+,.*,[0-9]+,.*,(Passenger|Crew),(Yes|No)$ ]]; then
-                sed -i '' "/$argname/ s/.*/$argnewdata/" "$filename"
-            else
-                echo "Invalid format. Please try again. (No spaces allowed - Case sensitive)"
-            fi
-            ;;
-        *)
-            echo "Invalid field."
-            return
-            ;;
-    esac
-
-    echo "Update complete."
+    echo "$results"
+
+    # The record is rewritten in place in the store; the CSV catches up on its next read
+    if "$tools_dir/passengerdb" update "$db" "$argname" "$selectedField" "$argnewdata"; then
+        echo "Update complete."
+    else
+        echo "Please try again. (Fields: fullname, age, country, status, rescued, record)"
+    fi
 }
 
 argumentHandler(){
@@ -116,6 +125,8 @@ argumentHandler(){
         return
     elif [[ $# -eq 1 && "$1" == "reports" ]]; then
         argflag=1
+    elif [[ $# -eq 1 && "$1" == "stats" ]]; then
+        argflag=3
     elif [[ $# -ge 3 ]]; then
         argflag=2
         local inNewdataField=false
@@ -150,12 +161,37 @@ argumentHandler(){
 
 display_file(){
 
-    read -p "Type anything to print data (spacebar to see more - q to Quit) or leave empty to skip: " choice
+    read -p "Type anything to print data or leave empty to skip: " choice
 
     if [[ -z $choice ]]; then
         return
     fi
-    cat "$filename" | less
+    ensure_store || return
+
+    # Filters come from the store's posting lists, e.g. "country=Greece status=Crew rescued=Yes"
+    read -p "Filter by country=, status= or rescued= (leave empty for everyone): " filters
+    local options=()
+    for filter in $filters; do
+        case ${filter%%=*} in
+            country) options+=(-c "${filter#*=}") ;;
+            status) options+=(-s "${filter#*=}") ;;
+            rescued) options+=(-r "${filter#*=}") ;;
+            *) echo "Unknown filter '$filter', ignored." ;;
+        esac
+    done
+
+    local page=1
+    while true; do
+        "$tools_dir/passengerdb" view "$db" -p "$page" "${options[@]}"
+        read -p "[n]ext, [p]revious, a page number, or q to quit: " choice
+        case $choice in
+            q|Q) break ;;
+            p|P) (( page > 1 )) && (( page-- )) ;;
+            ''|n|N) (( page++ )) ;;
+            *[!0-9]*) echo "Invalid choice." ;;
+            *) page=$choice ;;
+        esac
+    done
 }
 
 generate_reports() {
@@ -163,90 +199,25 @@ generate_reports() {
     #echo "Processing data from $file_to_process"
     echo "Processing data from $filename"
 
-    # Clear previous files to avoid appending data
-    > ages.txt
-    > percentages.txt
-    > avg.txt
-    > rescued.txt
-
-    # Generate ages_*.txt
-    awk -F'[;,]' '{
-        age = $3;
-        gsub(/^[ \t]+|[ \t]+$/, "", age);  # Remove leading and trailing whitespace
-        if (age ~ /^[0-9]+$/) {  # Check if age is a number
-            if (age <= 18) {
-                group = "ages 0-18";
-            } else if (age >= 19 && age <= 35) {
-                group = "ages 19-35";
-            } else if (age >= 36 && age <= 50) {
-                group = "ages 36-50";
-            } else {
-                group = "ages 51+";
-            }
-            data[group] = data[group] $0 "\n";  # Append the line to the respective group
-        }
-    } END {
-        # Write grouped data to the output file
-        for (g in data) {
-            print g ":" > "ages.txt";
-            print data[g] >> "ages.txt";
-            print "" >> "ages.txt";  # Add a blank line between groups
-        }
-    }' "$filename"
-
-    # Generate percentages.txt
-    awk -F'[;,]' '{
-        age = $3;
-        gsub(/^[ \t]+|[ \t]+$/, "", age);  # Remove leading and trailing whitespace
-        status = $6;
-        gsub(/^[ \t]+|[ \t]+$/, "", status);  # Remove leading and trailing whitespace
-        if (age ~ /^[0-9]+$/) {  # Check if age is a number
-            if (age <= 18) group = "0-18";
-            else if (age >= 19 && age <= 35) group = "19-35";
-            else if (age >= 36 && age <= 50) group = "36-50";
-            else group = "51+";
-
-            if (status ~ /^[Yy]es$/) rescued[group]++;
-            total[group]++;
-        }
-    } END {
-        printf "Percentages of rescued:\n" > "percentages.txt";
-        for (g in total) {
-            if (total[g] > 0) {
-                printf "ages %s: %.2f%%\n", g, (rescued[g] / total[g]) * 100 > "percentages.txt";
-            } else {
-                printf "%s: 0.00%%\n", g > "percentages.txt";
-            }
-        }
-    }' "$filename"
-
-    # Generate avg.txt
-    awk -F'[;,]' '{
-        category = $5;
-        gsub(/^[ \t]+|[ \t]+$/, "", category);  # Remove leading and trailing whitespace
-        age = $3;
-        gsub(/^[ \t]+|[ \t]+$/, "", age);  # Remove leading and trailing whitespace
-        if (age ~ /^[0-9]+$/) {  # Check if age is a number
-            ages[category] += age;
-            counts[category]++;
-        }
-    } END {
-        printf "Average age per passenger status:\n" > "avg.txt";
-        for (category in ages) {
-            if (counts[category] > 0) {
-                printf "%s: %.2f\n", category, ages[category] / counts[category] > "avg.txt";
-            }
-        }
-    }' "$filename"
-
-    # Generate rescued.txt
-    echo "Rescued passengers:" > rescued.txt
-    grep -E '[;,][Yy]es$' "$filename" >> rescued.txt
+    # One pass over the file builds ages.txt, percentages.txt, avg.txt and rescued.txt
+    if [[ ! -x "$tools_dir/reports" ]]; then
+        echo "Error: $tools_dir/reports not found, run make in $tools_dir first."
+        return
+    fi
+    ensure_csv || return
+    "$tools_dir/reports" "$filename"
 
 }
 
 
 
+# percentages.txt and avg.txt straight from the store's running counters: no
+# pass over the data, so they can be refreshed every few seconds
+generate_stats() {
+    ensure_store || return
+    "$tools_dir/passengerdb" reports "$db"
+}
+
 
 
 argflag=0
@@ -267,6 +238,9 @@ if [[ $argflag -eq 2 ]]; then
 elif [[ $argflag -eq 1 ]]; then
     generate_reports
     echo "Reports generated"
+elif [[ $argflag -eq 3 ]]; then
+    generate_stats
+    echo "Statistics updated"
 fi
 
 search_passenger
@@ -0,0 +1,323 @@
+// Report engine for the passenger manifest: one pass over a memory-mapped
+// CSV, split into chunks that threads scan in parallel. Writes the same four
+// files generate_reports() used to build with awk and grep:
+// ages.txt, percentages.txt, avg.txt and rescued.txt.
+//
+// ./reports <passengers.csv> [threads]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define NUM_GROUPS 4
+#define MAX_FIELDS 6
+
+static const char *group_names[NUM_GROUPS] = { "0-18", "19-35", "36-50", "51+" };
+
+// A line of the mapped file (without its newline)
+typedef struct span {
+    size_t offset;
+    size_t length;
+} span_t;
+
+typedef struct span_list {
+    span_t *items;
+    size_t count, capacity;
+} span_list_t;
+
+// Average age per status (the 5th field). The name points into the mapped file
+typedef struct category {
+    const char *name;
+    size_t length;
+    double age_sum;
+    long count;
+} category_t;
+
+// What one thread found in its chunk
+typedef struct chunk {
+    const char *data;
+    size_t begin, end;          // Byte range of whole lines in the file
+
+    span_list_t groups[NUM_GROUPS];
+    span_list_t rescued_lines;
+    long total[NUM_GROUPS];
+    long rescued[NUM_GROUPS];
+    category_t *categories;
+    int num_categories, categories_capacity;
+} chunk_t;
+
+static void span_push(span_list_t *list, size_t offset, size_t length) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 1024;
+        list->items = realloc(list->items, sizeof(span_t) * list->capacity);
+        if (!list->items) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->items[list->count].offset = offset;
+    list->items[list->count].length = length;
+    list->count++;
+}
+
+// Trim spaces and tabs around [*start, *end)
+static void trim(const char **start, const char **end) {
+    while (*start < *end && (**start == ' ' || **start == '\t')) (*start)++;
+    while (*end > *start && ((*end)[-1] == ' ' || (*end)[-1] == '\t')) (*end)--;
+}
+
+static int age_group(long age) {
+    if (age <= 18) return 0;
+    if (age <= 35) return 1;
+    if (age <= 50) return 2;
+    return 3;
+}
+
+static category_t *find_category(chunk_t *chunk, const char *name, size_t length) {
+    for (int i = 0; i < chunk->num_categories; i++) {
+        if (chunk->categories[i].length == length && memcmp(chunk->categories[i].name, name, length) == 0) {
+            return &chunk->categories[i];
+        }
+    }
+    if (chunk->num_categories == chunk->categories_capacity) {
+        chunk->categories_capacity = chunk->categories_capacity ? chunk->categories_capacity * 2 : 16;
+        chunk->categories = realloc(chunk->categories, sizeof(category_t) * chunk->categories_capacity);
+        if (!chunk->categories) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    category_t *category = &chunk->categories[chunk->num_categories++];
+    category->name = name;
+    category->length = length;
+    category->age_sum = 0;
+    category->count = 0;
+    return category;
+}
+
+// One CSV line: fields separated by ';' or ','
+static void scan_line(chunk_t *chunk, size_t offset, size_t length) {
+    const char *line = chunk->data + offset;
+    const char *end = line + length;
+    const char *field[MAX_FIELDS], *field_end[MAX_FIELDS];
+    int num_fields = 0;
+
+    const char *p = line;
+    while (num_fields < MAX_FIELDS) {
+        field[num_fields] = p;
+        while (p < end && *p != ',' && *p != ';') p++;
+        field_end[num_fields++] = p;
+        if (p == end) break;
+        p++;
+    }
+
+    // rescued.txt: the line ends in a ",yes" or ";yes" field
+    if (length >= 4 && (line[length - 4] == ',' || line[length - 4] == ';')
+        && (line[length - 3] == 'Y' || line[length - 3] == 'y')
+        && line[length - 2] == 'e' && line[length - 1] == 's') {
+        span_push(&chunk->rescued_lines, offset, length);
+    }
+
+    if (num_fields < 3) return;
+    const char *age_start = field[2], *age_end = field_end[2];
+    trim(&age_start, &age_end);
+    if (age_start == age_end) return;
+
+    long age = 0;
+    for (const char *d = age_start; d < age_end; d++) {
+        if (*d < '0' || *d > '9') return;  // Not a number: the row is skipped
+        if (age < 1000000) age = age * 10 + (*d - '0');
+    }
+
+    int group = age_group(age);
+    span_push(&chunk->groups[group], offset, length);
+    chunk->total[group]++;
+
+    if (num_fields >= 6) {
+        const char *status = field[5], *status_end = field_end[5];
+        trim(&status, &status_end);
+        if (status_end - status == 3 && (status[0] == 'Y' || status[0] == 'y')
+            && status[1] == 'e' && status[2] == 's') {
+            chunk->rescued[group]++;
+        }
+    }
+
+    const char *name = num_fields >= 5 ? field[4] : end;
+    const char *name_end = num_fields >= 5 ? field_end[4] : end;
+    trim(&name, &name_end);
+    category_t *category = find_category(chunk, name, name_end - name);
+    category->age_sum += age;
+    category->count++;
+}
+
+static void *scan_chunk(void *arg) {
+    chunk_t *chunk = arg;
+    size_t pos = chunk->begin;
+
+    while (pos < chunk->end) {
+        const char *newline = memchr(chunk->data + pos, '\n', chunk->end - pos);
+        size_t line_end = newline ? (size_t)(newline - chunk->data) : chunk->end;
+        size_t length = line_end - pos;
+        if (length > 0 && chunk->data[line_end - 1] == '\r') length--;
+        if (length > 0) scan_line(chunk, pos, length);
+        pos = line_end + 1;
+    }
+    return NULL;
+}
+
+// Chunk boundaries fall just after a newline, so every line belongs to one chunk
+static size_t line_start_after(const char *data, size_t size, size_t pos) {
+    if (pos == 0) return 0;
+    const char *newline = memchr(data + pos - 1, '\n', size - pos + 1);
+    return newline ? (size_t)(newline - data) + 1 : size;
+}
+
+static FILE *open_report(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 20);
+    return file;
+}
+
+static void write_lines(FILE *file, const char *data, span_list_t *list) {
+    for (size_t i = 0; i < list->count; i++) {
+        fwrite(data + list->items[i].offset, 1, list->items[i].length, file);
+        fputc('\n', file);
+    }
+}
+
+static void write_reports(const char *data, chunk_t *chunks, int num_chunks) {
+    // ages.txt: the rows of each age group, in file order
+    FILE *ages = open_report("ages.txt");
+    for (int g = 0; g < NUM_GROUPS; g++) {
+        long total = 0;
+        for (int c = 0; c < num_chunks; c++) total += chunks[c].total[g];
+        if (total == 0) continue;
+
+        fprintf(ages, "ages %s:\n", group_names[g]);
+        for (int c = 0; c < num_chunks; c++) write_lines(ages, data, &chunks[c].groups[g]);
+        fprintf(ages, "\n\n");
+    }
+    fclose(ages);
+
+    FILE *percentages = open_report("percentages.txt");
+    fprintf(percentages, "Percentages of rescued:\n");
+    for (int g = 0; g < NUM_GROUPS; g++) {
+        long total = 0, rescued = 0;
+        for (int c = 0; c < num_chunks; c++) {
+            total += chunks[c].total[g];
+            rescued += chunks[c].rescued[g];
+        }
+        if (total > 0) {
+            fprintf(percentages, "ages %s: %.2f%%\n", group_names[g], 100.0 * rescued / total);
+        }
+    }
+    fclose(percentages);
+
+    // avg.txt: merge the per-chunk categories, keeping first-seen order
+    chunk_t *merged = calloc(1, sizeof(chunk_t));
+    if (!merged) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int c = 0; c < num_chunks; c++) {
+        for (int i = 0; i < chunks[c].num_categories; i++) {
+            category_t *from = &chunks[c].categories[i];
+            category_t *into = find_category(merged, from->name, from->length);
+            into->age_sum += from->age_sum;
+            into->count += from->count;
+        }
+    }
+    FILE *avg = open_report("avg.txt");
+    fprintf(avg, "Average age per passenger status:\n");
+    for (int i = 0; i < merged->num_categories; i++) {
+        fprintf(avg, "%.*s: %.2f\n", (int)merged->categories[i].length, merged->categories[i].name,
+                merged->categories[i].age_sum / merged->categories[i].count);
+    }
+    fclose(avg);
+    free(merged->categories);
+    free(merged);
+
+    FILE *rescued = open_report("rescued.txt");
+    fprintf(rescued, "Rescued passengers:\n");
+    for (int c = 0; c < num_chunks; c++) write_lines(rescued, data, &chunks[c].rescued_lines);
+    fclose(rescued);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <passengers.csv> [threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int num_threads = argc >= 3 ? atoi(argv[2]) : (cores > 0 ? (int)cores : 1);
+    if (num_threads <= 0) {
+        fprintf(stderr, "Error: threads must be positive.\n");
+        return EXIT_FAILURE;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    if (fd == -1) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat");
+        return EXIT_FAILURE;
+    }
+    size_t size = st.st_size;
+
+    const char *data = "";
+    if (size > 0) {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            perror("mmap");
+            return EXIT_FAILURE;
+        }
+        madvise((void *)data, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    // Small files are not worth a thread per chunk
+    if ((size_t)num_threads > size / 65536 + 1) num_threads = (int)(size / 65536 + 1);
+
+    chunk_t *chunks = calloc(num_threads, sizeof(chunk_t));
+    pthread_t *threads = malloc(sizeof(pthread_t) * num_threads);
+    if (!chunks || !threads) {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < num_threads; i++) {
+        chunks[i].data = data;
+        chunks[i].begin = line_start_after(data, size, size / num_threads * i);
+        chunks[i].end = i + 1 < num_threads ? line_start_after(data, size, size / num_threads * (i + 1)) : size;
+        if (pthread_create(&threads[i], NULL, scan_chunk, &chunks[i]) != 0) {
+            perror("pthread_create");
+            return EXIT_FAILURE;
+        }
+    }
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    write_reports(data, chunks, num_threads);
+
+    for (int i = 0; i < num_threads; i++) {
+        for (int g = 0; g < NUM_GROUPS; g++) free(chunks[i].groups[g].items);
+        free(chunks[i].rescued_lines.items);
+        free(chunks[i].categories);
+    }
+    free(chunks);
+    free(threads);
+    if (size > 0) munmap((void *)data, size);
+    return 0;
+}
@@ -0,0 +1,469 @@
+#include "store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#define INITIAL_CAPACITY 1024
+#define INITIAL_INDEX_SLOTS 2048
+#define TOMBSTONE UINT32_MAX
+
+const char *status_names[NUM_STATUSES] = { "Passenger", "Crew" };
+const char *age_group_names[NUM_AGE_GROUPS] = { "0-18", "19-35", "36-50", "51+" };
+
+static uint64_t hash_code(const char *code) {
+    uint64_t hash = 14695981039346656037ull;  // FNV-1a
+    for (; *code; code++) {
+        hash = (hash ^ (unsigned char)*code) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t hash_name(const char *name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (; *name; name++) {
+        hash = (hash ^ (unsigned char)tolower((unsigned char)*name)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static size_t data_size(uint64_t capacity) {
+    return sizeof(store_header_t) + sizeof(passenger_t) * capacity;
+}
+
+static int protection(store_t *store) {
+    return store->writable ? PROT_READ | PROT_WRITE : PROT_READ;
+}
+
+static int map_data(store_t *store, size_t size) {
+    void *addr = mmap(NULL, size, protection(store), MAP_SHARED, store->fd, 0);
+    if (addr == MAP_FAILED) return -1;
+    store->header = addr;
+    store->records = (passenger_t *)(store->header + 1);
+    store->map_size = size;
+    return 0;
+}
+
+static int map_index(store_t *store, uint64_t slots) {
+    size_t size = sizeof(uint32_t) * slots * 2;
+    void *addr = mmap(NULL, size, protection(store), MAP_SHARED, store->index_fd, 0);
+    if (addr == MAP_FAILED) return -1;
+    store->code_index = addr;
+    store->name_index = store->code_index + slots;
+    store->index_map_size = size;
+    return 0;
+}
+
+static void index_add(uint32_t *table, uint64_t slots, uint64_t hash, long record) {
+    uint64_t mask = slots - 1;
+    for (uint64_t i = hash & mask;; i = (i + 1) & mask) {
+        if (table[i] == 0 || table[i] == TOMBSTONE) {
+            table[i] = (uint32_t)(record + 1);
+            return;
+        }
+    }
+}
+
+// Rebuild both tables with 'slots' entries each: on growth, and to drop tombstones
+static int rebuild_index(store_t *store, uint64_t slots) {
+    munmap(store->code_index, store->index_map_size);
+    if (ftruncate(store->index_fd, 0) == -1
+        || ftruncate(store->index_fd, sizeof(uint32_t) * slots * 2) == -1
+        || map_index(store, slots) == -1) {
+        return -1;
+    }
+
+    store->header->index_slots = slots;
+    store->header->index_used = store->header->count;
+    for (uint64_t n = 0; n < store->header->count; n++) {
+        index_add(store->code_index, slots, hash_code(store->records[n].code), n);
+        index_add(store->name_index, slots, hash_name(store->records[n].fullname), n);
+    }
+    return 0;
+}
+
+int age_group(int age) {
+    if (age <= 18) return 0;
+    if (age <= 35) return 1;
+    if (age <= 50) return 2;
+    return 3;
+}
+
+// Count a record in (sign 1) or out (sign -1) of the aggregates
+static void stats_add(store_stats_t *stats, const passenger_t *passenger, int sign) {
+    int group = age_group(passenger->age);
+    stats->group_total[group] += sign;
+    stats->group_rescued[group] += sign * passenger->rescued;
+    stats->status_count[passenger->status] += sign;
+    stats->status_age_sum[passenger->status] += sign * passenger->age;
+}
+
+// The posting lists a record belongs to
+static void list_keys(const passenger_t *passenger, const char *keys[NUM_LIST_KINDS]) {
+    keys[LIST_STATUS] = status_names[passenger->status];
+    keys[LIST_RESCUED] = passenger->rescued ? "Yes" : "No";
+    keys[LIST_COUNTRY] = passenger->country;
+}
+
+void store_recompute_stats(store_t *store, store_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (uint64_t n = 0; n < store->header->count; n++) {
+        stats_add(stats, &store->records[n], 1);
+    }
+}
+
+// Lay out an empty store in the open (and exclusively locked) files
+static int format_store(store_t *store) {
+    if (ftruncate(store->fd, 0) == -1 || ftruncate(store->index_fd, 0) == -1
+        || ftruncate(store->fd, data_size(INITIAL_CAPACITY)) == -1
+        || ftruncate(store->index_fd, sizeof(uint32_t) * INITIAL_INDEX_SLOTS * 2) == -1
+        || map_data(store, data_size(INITIAL_CAPACITY)) == -1
+        || map_index(store, INITIAL_INDEX_SLOTS) == -1
+        || postings_open(&store->postings, store->lists_path, 1, 1) == -1) {
+        return -1;
+    }
+    store->header->magic = STORE_MAGIC;
+    store->header->version = STORE_VERSION;
+    store->header->capacity = INITIAL_CAPACITY;
+    store->header->index_slots = INITIAL_INDEX_SLOTS;
+    return 0;
+}
+
+int store_open(store_t *store, const char *path, int mode) {
+    memset(store, 0, sizeof(*store));
+    snprintf(store->index_path, sizeof(store->index_path), "%s.idx", path);
+    snprintf(store->lists_path, sizeof(store->lists_path), "%s.lists", path);
+
+    // No O_TRUNC: a store is only emptied once its readers have let go of it
+    int flags = mode == STORE_READ ? O_RDONLY : O_RDWR | (mode == STORE_CREATE ? O_CREAT : 0);
+    store->fd = open(path, flags, 0644);
+    if (store->fd == -1) return -1;
+    store->writable = mode != STORE_READ;
+
+    int lock;
+    while ((lock = flock(store->fd, store->writable ? LOCK_EX : LOCK_SH)) == -1 && errno == EINTR);
+    if (lock == -1) {
+        int saved = errno;
+        close(store->fd);
+        errno = saved;
+        return -1;
+    }
+    store->index_fd = open(store->index_path, flags, 0644);
+    if (store->index_fd == -1) {
+        int saved = errno;
+        close(store->fd);
+        errno = saved;
+        return -1;
+    }
+
+    if (mode == STORE_CREATE) {
+        if (format_store(store) == -1) goto fail;
+        return 0;
+    }
+
+    store_header_t header;
+    struct stat st;
+    if (pread(store->fd, &header, sizeof(header), 0) != sizeof(header) || fstat(store->fd, &st) == -1) {
+        errno = EINVAL;
+        goto fail;
+    }
+    if (header.magic != STORE_MAGIC || header.version != STORE_VERSION
+        || (size_t)st.st_size < data_size(header.capacity)) {
+        errno = EINVAL;
+        goto fail;
+    }
+    if (map_data(store, data_size(header.capacity)) == -1
+        || map_index(store, header.index_slots) == -1
+        || postings_open(&store->postings, store->lists_path, store->writable, 0) == -1) {
+        goto fail;
+    }
+    return 0;
+
+fail:
+    {
+        int saved = errno;
+        close(store->fd);
+        close(store->index_fd);
+        errno = saved;
+    }
+    return -1;
+}
+
+int store_clear(store_t *store) {
+    munmap(store->header, store->map_size);
+    munmap(store->code_index, store->index_map_size);
+    postings_close(&store->postings);
+    return format_store(store);
+}
+
+void store_close(store_t *store) {
+    munmap(store->header, store->map_size);
+    munmap(store->code_index, store->index_map_size);
+    postings_close(&store->postings);
+    close(store->fd);
+    close(store->index_fd);
+}
+
+int store_reserve(store_t *store, uint64_t records) {
+    store_header_t *header = store->header;
+    if (records > header->capacity) {
+        uint64_t capacity = header->capacity;
+        while (capacity < records) capacity *= 2;
+        munmap(header, store->map_size);
+        if (ftruncate(store->fd, data_size(capacity)) == -1 || map_data(store, data_size(capacity)) == -1) {
+            return -1;
+        }
+        store->header->capacity = capacity;
+    }
+
+    uint64_t slots = store->header->index_slots;
+    while (records * 2 > slots / 2) slots *= 2;
+    if (slots > store->header->index_slots) return rebuild_index(store, slots);
+    return 0;
+}
+
+// Turn the entry pointing at 'record' into a tombstone
+static void index_remove(uint32_t *table, uint64_t slots, uint64_t hash, long record) {
+    uint64_t mask = slots - 1;
+    for (uint64_t i = hash & mask; table[i] != 0; i = (i + 1) & mask) {
+        if (table[i] == (uint32_t)(record + 1)) {
+            table[i] = TOMBSTONE;
+            return;
+        }
+    }
+}
+
+int store_update(store_t *store, long n, const passenger_t *passenger) {
+    store_header_t *header = store->header;
+    passenger_t *old = &store->records[n];
+    int code_changed = strcmp(old->code, passenger->code) != 0;
+    int name_changed = strcasecmp(old->fullname, passenger->fullname) != 0;
+
+    if (code_changed && store_find_code(store, passenger->code) != STORE_NOT_FOUND) return -1;
+
+    // New keys take fresh slots while the old ones become tombstones. When
+    // they fill the table it is rebuilt without them, at the same size unless
+    // the live keys alone need more room
+    if ((code_changed || name_changed) && (header->index_used + 1) * 2 > header->index_slots) {
+        uint64_t slots = header->index_slots;
+        while (header->count * 2 > slots / 2) slots *= 2;
+        if (rebuild_index(store, slots) == -1) {
+            perror("Index growth failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (code_changed) {
+        index_remove(store->code_index, header->index_slots, hash_code(old->code), n);
+        index_add(store->code_index, header->index_slots, hash_code(passenger->code), n);
+    }
+    if (name_changed) {
+        index_remove(store->name_index, header->index_slots, hash_name(old->fullname), n);
+        index_add(store->name_index, header->index_slots, hash_name(passenger->fullname), n);
+    }
+    if (code_changed || name_changed) header->index_used++;
+
+    stats_add(&header->stats, old, -1);
+    stats_add(&header->stats, passenger, 1);
+    const char *old_keys[NUM_LIST_KINDS], *keys[NUM_LIST_KINDS];
+    list_keys(old, old_keys);
+    list_keys(passenger, keys);
+    postings_move(&store->postings, old_keys, keys, n);
+    *old = *passenger;
+    return 0;
+}
+
+int store_sync(store_t *store) {
+    if (msync(store->header, store->map_size, MS_SYNC) == -1
+        || msync(store->code_index, store->index_map_size, MS_SYNC) == -1) {
+        return -1;
+    }
+    return postings_sync(&store->postings);
+}
+
+long store_find_code(store_t *store, const char *code) {
+    uint64_t mask = store->header->index_slots - 1;
+    for (uint64_t i = hash_code(code) & mask;; i = (i + 1) & mask) {
+        uint32_t entry = store->code_index[i];
+        if (entry == 0) return STORE_NOT_FOUND;
+        if (entry != TOMBSTONE && strcmp(store->records[entry - 1].code, code) == 0) return entry - 1;
+    }
+}
+
+long store_next_by_name(store_t *store, const char *name, uint64_t *cursor) {
+    uint64_t mask = store->header->index_slots - 1;
+    uint64_t start = hash_name(name) & mask;
+
+    // The cursor counts probes from the home slot, so a scan resumes where it stopped
+    for (uint64_t i = (start + *cursor) & mask;; i = (i + 1) & mask) {
+        uint32_t entry = store->name_index[i];
+        (*cursor)++;
+        if (entry == 0) return STORE_NOT_FOUND;
+        if (entry != TOMBSTONE && strcasecmp(store->records[entry - 1].fullname, name) == 0) return entry - 1;
+    }
+}
+
+long store_insert(store_t *store, const passenger_t *passenger) {
+    store_header_t *header = store->header;
+    if (store_find_code(store, passenger->code) != STORE_NOT_FOUND) return STORE_NOT_FOUND;
+
+    if (header->count == header->capacity) {
+        uint64_t capacity = header->capacity * 2;
+        size_t old_size = store->map_size;
+        munmap(header, old_size);
+        if (ftruncate(store->fd, data_size(capacity)) == -1 || map_data(store, data_size(capacity)) == -1) {
+            perror("Store growth failed");
+            exit(EXIT_FAILURE);
+        }
+        header = store->header;
+        header->capacity = capacity;
+    }
+
+    // Keep each table at most half full so probe sequences stay short
+    if ((header->index_used + 1) * 2 > header->index_slots) {
+        uint64_t slots = header->index_slots;
+        while ((header->count + 1) * 2 > slots / 2) slots *= 2;
+        if (rebuild_index(store, slots) == -1) {
+            perror("Index growth failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    long n = (long)header->count;
+    store->records[n] = *passenger;
+    index_add(store->code_index, header->index_slots, hash_code(passenger->code), n);
+    index_add(store->name_index, header->index_slots, hash_name(passenger->fullname), n);
+    header->index_used++;
+    header->count++;
+    stats_add(&header->stats, passenger, 1);
+    const char *keys[NUM_LIST_KINDS];
+    list_keys(passenger, keys);
+    postings_add(&store->postings, keys, n);
+    return n;
+}
+
+// Copy [start, end) into a fixed-size field. Returns -1 if it does not fit
+static int copy_field(char *to, size_t size, const char *start, const char *end) {
+    if (end - start >= (long)size) return -1;
+    memcpy(to, start, end - start);
+    to[end - start] = '\0';
+    return 0;
+}
+
+static int all_digits(const char *start, const char *end) {
+    if (start == end) return 0;
+    for (; start < end; start++) {
+        if (*start < '0' || *start > '9') return 0;
+    }
+    return 1;
+}
+
+int passenger_parse(const char *line, size_t length, passenger_t *passenger, const char **error) {
+    const char *field[6], *field_end[6];
+    const char *p = line, *end = line + length;
+    int num_fields = 0;
+
+    if (length > 0 && end[-1] == '\r') end--;
+    while (1) {
+        if (num_fields == 6) {
+            *error = "too many fields";
+            return -1;
+        }
+        field[num_fields] = p;
+        while (p < end && *p != ',' && *p != ';') p++;
+        field_end[num_fields++] = p;
+        if (p == end) break;
+        p++;
+    }
+    if (num_fields != 6) {
+        *error = "expected 6 fields";
+        return -1;
+    }
+
+    memset(passenger, 0, sizeof(*passenger));
+    if (!all_digits(field[0], field_end[0]) || copy_field(passenger->code, CODE_LEN, field[0], field_end[0])) {
+        *error = "code must be a number";
+        return -1;
+    }
+    if (field[1] == field_end[1] || copy_field(passenger->fullname, NAME_LEN, field[1], field_end[1])) {
+        *error = "full name is empty or too long";
+        return -1;
+    }
+    if (!all_digits(field[2], field_end[2]) || field_end[2] - field[2] > 3) {
+        *error = "age must be a number";
+        return -1;
+    }
+    passenger->age = atoi(field[2]);
+    if (copy_field(passenger->country, COUNTRY_LEN, field[3], field_end[3])) {
+        *error = "country is too long";
+        return -1;
+    }
+
+    size_t status_len = field_end[4] - field[4];
+    if (status_len == 9 && strncmp(field[4], "Passenger", 9) == 0) {
+        passenger->status = STATUS_PASSENGER;
+    } else if (status_len == 4 && strncmp(field[4], "Crew", 4) == 0) {
+        passenger->status = STATUS_CREW;
+    } else {
+        *error = "status must be Passenger or Crew";
+        return -1;
+    }
+
+    size_t rescued_len = field_end[5] - field[5];
+    if (rescued_len == 3 && strncmp(field[5], "Yes", 3) == 0) {
+        passenger->rescued = 1;
+    } else if (rescued_len == 2 && strncmp(field[5], "No", 2) == 0) {
+        passenger->rescued = 0;
+    } else {
+        *error = "rescued must be Yes or No";
+        return -1;
+    }
+    return 0;
+}
+
+int passenger_format(const passenger_t *passenger, char *buf, size_t size) {
+    return snprintf(buf, size, "%s,%s,%d,%s,%s,%s", passenger->code, passenger->fullname,
+                    passenger->age, passenger->country, status_names[passenger->status],
+                    passenger->rescued ? "Yes" : "No");
+}
+
+int passenger_set_field(passenger_t *passenger, const char *field, const char *value, const char **error) {
+    static const char *fields[] = { "code", "fullname", "age", "country", "status", "rescued" };
+    char line[512];
+    int length;
+
+    if (strcmp(field, "record") == 0) {
+        length = snprintf(line, sizeof(line), "%s", value);
+    } else {
+        // Rebuild the CSV line with the new value and validate it as a whole
+        char age[16];
+        const char *values[6] = { passenger->code, passenger->fullname, age, passenger->country,
+                                  status_names[passenger->status], passenger->rescued ? "Yes" : "No" };
+        snprintf(age, sizeof(age), "%d", passenger->age);
+
+        int i = 1;  // The code is the key, it only changes with "record"
+        while (i < 6 && strcmp(field, fields[i]) != 0) i++;
+        if (i == 6) {
+            *error = "unknown field";
+            return -1;
+        }
+        values[i] = value;
+        length = snprintf(line, sizeof(line), "%s,%s,%s,%s,%s,%s",
+                          values[0], values[1], values[2], values[3], values[4], values[5]);
+    }
+    if (length < 0 || (size_t)length >= sizeof(line)) {
+        *error = "value is too long";
+        return -1;
+    }
+
+    passenger_t changed;
+    if (passenger_parse(line, length, &changed, error) != 0) return -1;
+    *passenger = changed;
+    return 0;
+}
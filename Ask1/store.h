@@ -0,0 +1,142 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "postings.h"
+
+// Passenger store: a file of fixed-size records (<manifest>.db) and a
+// persistent index file (<manifest>.db.idx) holding two open-addressing hash
+// tables, one on the code and one on the case-folded full name. Both files
+// are memory-mapped; the indexes are updated on every insert and update, and
+// an update rewrites its record in place. Posting lists by status, rescued
+// and country (<manifest>.db.lists, see postings.h) drive the filtered views.
+//
+// Concurrent clients follow a multi-reader/single-writer protocol: readers
+// hold a shared flock on the data file while it is open, writers an
+// exclusive one, so a search never sees a record or an index half-written
+// and two writers never interleave.
+
+#define STORE_MAGIC 0x42445350u  // "PSDB"
+#define STORE_VERSION 4
+
+#define CODE_LEN 24
+#define NAME_LEN 64
+#define COUNTRY_LEN 40
+
+enum { STATUS_PASSENGER, STATUS_CREW, NUM_STATUSES };
+
+// Age groups of the reports: 0-18, 19-35, 36-50, 51+
+#define NUM_AGE_GROUPS 4
+extern const char *age_group_names[NUM_AGE_GROUPS];
+extern const char *status_names[NUM_STATUSES];
+
+typedef struct passenger {
+    char code[CODE_LEN];
+    char fullname[NAME_LEN];
+    char country[COUNTRY_LEN];
+    int32_t age;
+    uint8_t status;
+    uint8_t rescued;
+    uint8_t pad[2];
+} passenger_t;
+
+// Running aggregates behind the summary reports, kept up to date by every
+// insert and update so the reports never scan the records
+typedef struct store_stats {
+    uint64_t group_total[NUM_AGE_GROUPS];
+    uint64_t group_rescued[NUM_AGE_GROUPS];
+    uint64_t status_count[NUM_STATUSES];
+    uint64_t status_age_sum[NUM_STATUSES];
+} store_stats_t;
+
+typedef struct store_header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t count;         // Records in use
+    uint64_t capacity;      // Record slots in the file
+    uint64_t index_slots;   // Slots of each hash table (a power of 2)
+    uint64_t index_used;    // Used slots of each table, tombstones included
+    store_stats_t stats;
+    uint64_t reserved[3];
+} store_header_t;
+
+typedef struct store {
+    int fd;
+    int index_fd;
+    int writable;           // Opened with an exclusive lock
+    store_header_t *header;
+    passenger_t *records;   // Right after the header
+    size_t map_size;
+    uint32_t *code_index;   // Record number + 1, 0 when empty
+    uint32_t *name_index;
+    size_t index_map_size;
+    char index_path[4096];
+    char lists_path[4096];
+    postings_t postings;
+} store_t;
+
+#define STORE_NOT_FOUND (-1L)
+
+enum {
+    STORE_READ,     // Shared lock, read-only mapping
+    STORE_WRITE,    // Exclusive lock
+    STORE_CREATE    // Exclusive lock, and the store is emptied (or created)
+};
+
+// Open a store, blocking until its lock is granted. Returns 0, or -1 with
+// errno set. The lock is released by store_close
+int store_open(store_t *store, const char *path, int mode);
+void store_close(store_t *store);
+
+// Empty a store opened for writing, as STORE_CREATE would, without letting
+// go of its lock. Returns 0, or -1 with errno set
+int store_clear(store_t *store);
+
+static inline passenger_t *store_record(store_t *store, long n) {
+    return &store->records[n];
+}
+
+static inline long store_count(store_t *store) {
+    return (long)store->header->count;
+}
+
+// Append a record and index it. Returns its number, or STORE_NOT_FOUND if
+// the code is already taken
+long store_insert(store_t *store, const passenger_t *passenger);
+
+// Grow the file and the indexes for 'records' records at once, so a bulk
+// load appends without remapping. Returns 0, or -1 with errno set
+int store_reserve(store_t *store, uint64_t records);
+
+// Overwrite record n, re-indexing its code and name if they changed.
+// Returns 0, or -1 if the new code belongs to another record
+int store_update(store_t *store, long n, const passenger_t *passenger);
+
+// Flush the mapped records and indexes to disk (msync). Writers call it
+// once per batch of changes: a group commit
+int store_sync(store_t *store);
+
+long store_find_code(store_t *store, const char *code);
+
+int age_group(int age);
+
+// Aggregates recomputed from every record, to check the running ones
+void store_recompute_stats(store_t *store, store_stats_t *stats);
+
+// Every record whose full name matches case-insensitively: start with
+// *cursor = 0 and call until STORE_NOT_FOUND
+long store_next_by_name(store_t *store, const char *name, uint64_t *cursor);
+
+// Parse "code,fullname,age,country,status,rescued" (',' or ';' separated,
+// status Passenger|Crew, rescued Yes|No). Returns 0, or -1 and a reason
+int passenger_parse(const char *line, size_t length, passenger_t *passenger, const char **error);
+
+// The record as a CSV line without the newline. Returns its length
+int passenger_format(const passenger_t *passenger, char *buf, size_t size);
+
+// Change one field (fullname, age, country, status, rescued) or the whole
+// record ("record", value in CSV form), validated like passenger_parse
+int passenger_set_field(passenger_t *passenger, const char *field, const char *value, const char **error);
+
+#endif // STORE_H
@@ -0,0 +1,77 @@
+#include "boarding.h"
+#include "ipc_utils.h"
+#include "stats.h"
+#include <sched.h>
+
+void dock_init(dock_t *dock) {
+    atomic_init(&dock->seats, 0);
+    atomic_init(&dock->boarded, 0);
+    dock->expected = 0;
+    dock->boat_id = 0;
+    init_semaphore(&dock->turn, 1);
+}
+
+void dock_destroy(dock_t *dock) {
+    destroy_semaphore(&dock->turn);
+}
+
+int dock_load_boat(dock_t *dock, int boat_id, int n, int timeout_ms) {
+    while (sem_wait(&dock->turn) != 0) {}  // Retry on EINTR
+
+    // Publish the trip before the seats: a passenger that takes a seat sees it
+    dock->boat_id = boat_id;
+    dock->expected = n;
+    atomic_store_explicit(&dock->boarded, 0, memory_order_relaxed);
+    atomic_store_explicit(&dock->seats, n, memory_order_release);
+    futex_wake(&dock->seats, n);
+
+    // Boarded-count barrier: the last passenger to board wakes us once
+    double deadline = now_secs() + timeout_ms / 1000.0;
+    int boarded;
+    while ((boarded = atomic_load_explicit(&dock->boarded, memory_order_acquire)) < n) {
+        if (timeout_ms < 0) {
+            futex_wait(&dock->boarded, boarded);
+            continue;
+        }
+
+        double left = deadline - now_secs();
+        if (left <= 0) {
+            // Revoke the free seats. Passengers that already took one are
+            // between their CAS and the boarded count, so wait for them briefly
+            int target = n - atomic_exchange_explicit(&dock->seats, 0, memory_order_acquire);
+            while (atomic_load_explicit(&dock->boarded, memory_order_acquire) < target) {
+                sched_yield();
+            }
+            n = target;
+            break;
+        }
+        futex_wait_timeout(&dock->boarded, boarded, (int)(left * 1000) + 1);
+    }
+
+    sem_post(&dock->turn);
+    return n;
+}
+
+int dock_board(dock_t *dock) {
+    int seats = atomic_load_explicit(&dock->seats, memory_order_acquire);
+
+    while (1) {
+        if (seats == 0) {
+            futex_wait(&dock->seats, 0);  // Returns at once if seats opened meanwhile
+            seats = atomic_load_explicit(&dock->seats, memory_order_acquire);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&dock->seats, &seats, seats - 1,
+                                                  memory_order_acquire, memory_order_acquire)) {
+            break;
+        }
+    }
+
+    // Read the trip before boarding: once everyone is on, the next boat may overwrite it
+    int boat_id = dock->boat_id;
+    int expected = dock->expected;
+    if (atomic_fetch_add_explicit(&dock->boarded, 1, memory_order_release) + 1 == expected) {
+        futex_wake(&dock->boarded, 1);
+    }
+    return boat_id;
+}
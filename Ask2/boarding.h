@@ -0,0 +1,30 @@
+#ifndef BOARDING_H
+#define BOARDING_H
+
+#include <semaphore.h>
+#include <stdatomic.h>
+
+// Αποβάθρα: μία λέμβος τη φορά ανοίγει θέσεις και περιμένει να γεμίσουν
+typedef struct dock {
+    atomic_int seats;       // Ελεύθερες θέσεις της λέμβου που φορτώνει
+    atomic_int boarded;     // Επιβάτες που επιβιβάστηκαν στο τρέχον ταξίδι
+    int expected;           // Θέσεις που άνοιξαν για το τρέχον ταξίδι
+    int boat_id;            // Λέμβος που βρίσκεται στην αποβάθρα
+    sem_t turn;             // Μία λέμβος τη φορά στην αποβάθρα
+} dock_t;
+
+// Η αποβάθρα πρέπει να βρίσκεται σε κοινόχρηστη μνήμη για χρήση από διεργασίες
+
+void dock_init(dock_t *dock);
+void dock_destroy(dock_t *dock);
+
+// Λέμβος: ανοίγει n θέσεις με μία ατομική εγγραφή και ένα futex wake,
+// και περιμένει μέχρι να επιβιβαστούν και οι n επιβάτες. Με timeout_ms >= 0
+// ανακαλεί όσες θέσεις δεν πιάστηκαν ως την προθεσμία και φεύγει μισοάδεια.
+// Επιστρέφει πόσοι επιβιβάστηκαν
+int dock_load_boat(dock_t *dock, int boat_id, int n, int timeout_ms);
+
+// Επιβάτης: περιμένει ελεύθερη θέση και επιβιβάζεται. Επιστρέφει τη λέμβο
+int dock_board(dock_t *dock);
+
+#endif // BOARDING_H
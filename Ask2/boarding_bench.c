@@ -0,0 +1,381 @@
+// Benchmark of the boat/passenger boarding handshake under different
+// synchronization backends. A boat opens n seats and waits until n
+// passengers have boarded; one boat at a time is at the dock.
+//
+// ./boarding_bench [-b backend] [-n boardings] [-p threads,...] [-B boats,...] [-c capacity,...]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include "ipc_utils.h"
+#include "boarding.h"
+#include "stats.h"
+
+#define MAX_SWEEP 16
+#define SPINS_BEFORE_YIELD 100
+
+typedef struct backend {
+    const char *name;
+    void *(*create)(void);
+    void (*destroy)(void *dock);
+    void (*load_boat)(void *dock, int boat_id, int n);
+    int (*board)(void *dock);
+} backend_t;
+
+static void *alloc_dock(size_t size) {
+    void *dock = calloc(1, size);
+    if (!dock) handle_error("calloc");
+    return dock;
+}
+
+static void sem_wait_retry(sem_t *sem) {
+    while (sem_wait(sem) != 0) {}  // Retry on EINTR
+}
+
+// Futex dock: the one the simulation uses
+
+static void *futex_create(void) {
+    dock_t *dock = alloc_dock(sizeof(dock_t));
+    dock_init(dock);
+    return dock;
+}
+
+static void futex_destroy(void *dock) {
+    dock_destroy(dock);
+    free(dock);
+}
+
+static void futex_load(void *dock, int boat_id, int n) {
+    dock_load_boat(dock, boat_id, n, -1);
+}
+
+static int futex_board(void *dock) {
+    return dock_board(dock);
+}
+
+// Semaphores: one post per seat and one per boarded passenger.
+// The same code runs on unnamed pshared semaphores and on named ones
+
+typedef struct sem_dock {
+    sem_t *turn, *seats, *boarded;
+    sem_t storage[3];       // Unnamed semaphores
+    int boat_id;
+} sem_dock_t;
+
+static void *unnamed_create(void) {
+    sem_dock_t *dock = alloc_dock(sizeof(sem_dock_t));
+    dock->turn = &dock->storage[0];
+    dock->seats = &dock->storage[1];
+    dock->boarded = &dock->storage[2];
+    init_semaphore(dock->turn, 1);
+    init_semaphore(dock->seats, 0);
+    init_semaphore(dock->boarded, 0);
+    return dock;
+}
+
+static void unnamed_destroy(void *arg) {
+    sem_dock_t *dock = arg;
+    for (int i = 0; i < 3; i++) destroy_semaphore(&dock->storage[i]);
+    free(dock);
+}
+
+// Named semaphores are unlinked at once: only the handles are needed
+static sem_t *open_named(int value) {
+    char name[64];
+    ipc_unique_name(name, sizeof(name), "bench");
+    sem_t *sem = sem_open(name, O_CREAT | O_EXCL, 0600, value);
+    if (sem == SEM_FAILED) handle_error("sem_open");
+    sem_unlink(name);
+    return sem;
+}
+
+static void *named_create(void) {
+    sem_dock_t *dock = alloc_dock(sizeof(sem_dock_t));
+    dock->turn = open_named(1);
+    dock->seats = open_named(0);
+    dock->boarded = open_named(0);
+    return dock;
+}
+
+static void named_destroy(void *arg) {
+    sem_dock_t *dock = arg;
+    sem_close(dock->turn);
+    sem_close(dock->seats);
+    sem_close(dock->boarded);
+    free(dock);
+}
+
+static void sem_load(void *arg, int boat_id, int n) {
+    sem_dock_t *dock = arg;
+    sem_wait_retry(dock->turn);
+    dock->boat_id = boat_id;
+    for (int i = 0; i < n; i++) sem_post(dock->seats);
+    for (int i = 0; i < n; i++) sem_wait_retry(dock->boarded);
+    sem_post(dock->turn);
+}
+
+static int sem_board(void *arg) {
+    sem_dock_t *dock = arg;
+    sem_wait_retry(dock->seats);
+    int boat_id = dock->boat_id;  // Stable: the boat waits for us before leaving
+    sem_post(dock->boarded);
+    return boat_id;
+}
+
+// Mutex and condition variables
+
+typedef struct cond_dock {
+    pthread_mutex_t lock;
+    pthread_cond_t seat_open;
+    pthread_cond_t all_boarded;
+    pthread_cond_t dock_free;
+    int busy, seats, boarded, expected, boat_id;
+} cond_dock_t;
+
+static void *cond_create(void) {
+    cond_dock_t *dock = alloc_dock(sizeof(cond_dock_t));
+    pthread_mutex_init(&dock->lock, NULL);
+    pthread_cond_init(&dock->seat_open, NULL);
+    pthread_cond_init(&dock->all_boarded, NULL);
+    pthread_cond_init(&dock->dock_free, NULL);
+    return dock;
+}
+
+static void cond_destroy(void *arg) {
+    cond_dock_t *dock = arg;
+    pthread_mutex_destroy(&dock->lock);
+    pthread_cond_destroy(&dock->seat_open);
+    pthread_cond_destroy(&dock->all_boarded);
+    pthread_cond_destroy(&dock->dock_free);
+    free(dock);
+}
+
+static void cond_load(void *arg, int boat_id, int n) {
+    cond_dock_t *dock = arg;
+    pthread_mutex_lock(&dock->lock);
+    while (dock->busy) pthread_cond_wait(&dock->dock_free, &dock->lock);
+    dock->busy = 1;
+    dock->boat_id = boat_id;
+    dock->expected = n;
+    dock->boarded = 0;
+    dock->seats = n;
+    pthread_cond_broadcast(&dock->seat_open);
+    while (dock->boarded < n) pthread_cond_wait(&dock->all_boarded, &dock->lock);
+    dock->busy = 0;
+    pthread_cond_signal(&dock->dock_free);
+    pthread_mutex_unlock(&dock->lock);
+}
+
+static int cond_board(void *arg) {
+    cond_dock_t *dock = arg;
+    pthread_mutex_lock(&dock->lock);
+    while (dock->seats == 0) pthread_cond_wait(&dock->seat_open, &dock->lock);
+    dock->seats--;
+    int boat_id = dock->boat_id;
+    if (++dock->boarded == dock->expected) pthread_cond_signal(&dock->all_boarded);
+    pthread_mutex_unlock(&dock->lock);
+    return boat_id;
+}
+
+// Atomics only: every wait spins, yielding the CPU now and then
+
+typedef struct spin_dock {
+    atomic_int turn;
+    atomic_int seats;
+    atomic_int boarded;
+    int expected, boat_id;
+} spin_dock_t;
+
+static void spin_pause(int *spins) {
+    if (++*spins % SPINS_BEFORE_YIELD == 0) sched_yield();
+}
+
+static void *spin_create(void) {
+    return alloc_dock(sizeof(spin_dock_t));  // All zero: dock free, no seats
+}
+
+static void spin_destroy(void *dock) {
+    free(dock);
+}
+
+static void spin_load(void *arg, int boat_id, int n) {
+    spin_dock_t *dock = arg;
+    int free_dock = 0, spins = 0;
+    while (!atomic_compare_exchange_weak(&dock->turn, &free_dock, 1)) {
+        free_dock = 0;
+        spin_pause(&spins);
+    }
+    dock->boat_id = boat_id;
+    dock->expected = n;
+    atomic_store_explicit(&dock->boarded, 0, memory_order_relaxed);
+    atomic_store_explicit(&dock->seats, n, memory_order_release);
+    while (atomic_load_explicit(&dock->boarded, memory_order_acquire) < n) spin_pause(&spins);
+    atomic_store_explicit(&dock->turn, 0, memory_order_release);
+}
+
+static int spin_board(void *arg) {
+    spin_dock_t *dock = arg;
+    int spins = 0;
+    int seats = atomic_load_explicit(&dock->seats, memory_order_acquire);
+    while (seats == 0 || !atomic_compare_exchange_weak_explicit(&dock->seats, &seats, seats - 1,
+                                                                 memory_order_acquire, memory_order_acquire)) {
+        if (seats == 0) {
+            spin_pause(&spins);
+            seats = atomic_load_explicit(&dock->seats, memory_order_acquire);
+        }
+    }
+    int boat_id = dock->boat_id;
+    atomic_fetch_add_explicit(&dock->boarded, 1, memory_order_release);
+    return boat_id;
+}
+
+static const backend_t backends[] = {
+    { "futex", futex_create, futex_destroy, futex_load, futex_board },
+    { "pshared-sem", unnamed_create, unnamed_destroy, sem_load, sem_board },
+    { "named-sem", named_create, named_destroy, sem_load, sem_board },
+    { "condvar", cond_create, cond_destroy, cond_load, cond_board },
+    { "spin", spin_create, spin_destroy, spin_load, spin_board },
+};
+#define NUM_BACKENDS (int)(sizeof(backends) / sizeof(backends[0]))
+
+// One benchmark run
+
+typedef struct run {
+    const backend_t *backend;
+    void *dock;
+    int capacity;
+    atomic_long seats_left;     // Seats boats still have to open
+    atomic_long boardings_left; // Boardings passengers still have to do
+    atomic_long trips;
+    latency_hist_t latency;     // Time a passenger waits in board()
+} run_t;
+
+typedef struct boat_arg {
+    run_t *run;
+    int boat_id;
+} boat_arg_t;
+
+static void *bench_boat(void *arg) {
+    boat_arg_t *boat = arg;
+    run_t *run = boat->run;
+
+    while (1) {
+        long before = atomic_fetch_sub(&run->seats_left, run->capacity);
+        if (before <= 0) break;
+        run->backend->load_boat(run->dock, boat->boat_id, before < run->capacity ? (int)before : run->capacity);
+        atomic_fetch_add_explicit(&run->trips, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static void *bench_passenger(void *arg) {
+    run_t *run = arg;
+
+    while (atomic_fetch_sub(&run->boardings_left, 1) > 0) {
+        double start = now_secs();
+        run->backend->board(run->dock);
+        hist_record(&run->latency, now_secs() - start);
+    }
+    return NULL;
+}
+
+static void bench(const backend_t *backend, long boardings, int passengers, int boats, int capacity) {
+    run_t *run = malloc(sizeof(run_t));
+    if (!run) handle_error("malloc");
+    run->backend = backend;
+    run->dock = backend->create();
+    run->capacity = capacity;
+    atomic_init(&run->seats_left, boardings);
+    atomic_init(&run->boardings_left, boardings);
+    atomic_init(&run->trips, 0);
+    hist_init(&run->latency);
+
+    pthread_t threads[passengers + boats];
+    boat_arg_t boat_args[boats];
+
+    double start = now_secs();
+    for (int i = 0; i < boats; i++) {
+        boat_args[i].run = run;
+        boat_args[i].boat_id = i + 1;
+        if (pthread_create(&threads[i], NULL, bench_boat, &boat_args[i]) != 0) handle_error("pthread_create");
+    }
+    for (int i = 0; i < passengers; i++) {
+        if (pthread_create(&threads[boats + i], NULL, bench_passenger, run) != 0) handle_error("pthread_create");
+    }
+    for (int i = 0; i < passengers + boats; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double elapsed = now_secs() - start;
+    if (elapsed <= 0) elapsed = 1e-9;
+
+    printf("%s,%d,%d,%d,%.0f,%.0f,%.2f,%.2f,%.2f\n", backend->name, passengers, boats, capacity,
+           atomic_load(&run->trips) / elapsed, boardings / elapsed,
+           hist_mean(&run->latency) * 1e6, hist_percentile(&run->latency, 50) * 1e6,
+           hist_percentile(&run->latency, 99) * 1e6);
+    fflush(stdout);
+
+    backend->destroy(run->dock);
+    free(run);
+}
+
+// Comma-separated positive integers. Returns the count, or -1
+static int parse_list(const char *text, int *values) {
+    int count = 0;
+    char *copy = strdup(text);
+    for (char *save, *item = strtok_r(copy, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        if (count == MAX_SWEEP || (values[count] = atoi(item)) <= 0) {
+            count = -1;
+            break;
+        }
+        count++;
+    }
+    free(copy);
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    const char *only = NULL;
+    long boardings = 100000;
+    int passengers[MAX_SWEEP] = { 4, 16, 64 }, num_passengers = 3;
+    int boats[MAX_SWEEP] = { 1, 4 }, num_boats = 2;
+    int capacities[MAX_SWEEP] = { 1, 10, 50 }, num_capacities = 3;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:n:p:B:c:")) != -1) {
+        switch (opt) {
+            case 'b': only = optarg; break;
+            case 'n': boardings = atol(optarg); break;
+            case 'p': num_passengers = parse_list(optarg, passengers); break;
+            case 'B': num_boats = parse_list(optarg, boats); break;
+            case 'c': num_capacities = parse_list(optarg, capacities); break;
+            default: num_passengers = -1; break;
+        }
+    }
+    if (boardings <= 0 || num_passengers <= 0 || num_boats <= 0 || num_capacities <= 0) {
+        printf("Usage: %s [-b backend] [-n boardings] [-p threads,...] [-B boats,...] [-c capacity,...]\n", argv[0]);
+        printf("Backends:");
+        for (int i = 0; i < NUM_BACKENDS; i++) printf(" %s", backends[i].name);
+        printf("\n");
+        return EXIT_FAILURE;
+    }
+
+    int found = 0;
+    printf("backend,passengers,boats,capacity,trips/s,passengers/s,board_mean_us,board_p50_us,board_p99_us\n");
+    for (int b = 0; b < NUM_BACKENDS; b++) {
+        if (only && strcmp(only, backends[b].name) != 0) continue;
+        found = 1;
+        for (int p = 0; p < num_passengers; p++)
+            for (int o = 0; o < num_boats; o++)
+                for (int c = 0; c < num_capacities; c++)
+                    bench(&backends[b], boardings, passengers[p], boats[o], capacities[c]);
+    }
+    if (!found) {
+        printf("Error: unknown backend %s.\n", only);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
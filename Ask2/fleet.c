@@ -0,0 +1,116 @@
+#include "fleet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+double unit_sample(unsigned *seed) {
+    return rand_r(seed) / ((double)RAND_MAX + 1);
+}
+
+static int parse_dist(const char *name, trip_dist_t *dist) {
+    if (strcmp(name, "fixed") == 0) *dist = TRIP_FIXED;
+    else if (strcmp(name, "uniform") == 0) *dist = TRIP_UNIFORM;
+    else if (strcmp(name, "exp") == 0) *dist = TRIP_EXP;
+    else return -1;
+    return 0;
+}
+
+int fleet_parse(const char *spec, boat_spec_t **fleet) {
+    char *copy = strdup(spec);
+    int total = 0;
+    boat_spec_t *boats = NULL;
+
+    for (char *save, *group = strtok_r(copy, ",", &save); group; group = strtok_r(NULL, ",", &save)) {
+        int count, capacity, used = 0;
+        char dist_name[16] = "fixed";
+        double mean_ms = 0;
+
+        if (sscanf(group, "%dx%d%n", &count, &capacity, &used) != 2) goto fail;
+        if (group[used] == ':' && sscanf(group + used, ":%15[a-z]:%lf", dist_name, &mean_ms) != 2) goto fail;
+        if (group[used] != ':' && group[used] != '\0') goto fail;
+
+        boat_spec_t proto;
+        proto.capacity = capacity;
+        proto.mean_secs = mean_ms / 1000.0;
+        if (count <= 0 || capacity <= 0 || mean_ms < 0 || parse_dist(dist_name, &proto.dist) != 0) goto fail;
+
+        boat_spec_t *grown = realloc(boats, sizeof(boat_spec_t) * (total + count));
+        if (!grown) goto fail;
+        boats = grown;
+        for (int i = 0; i < count; i++) boats[total++] = proto;
+    }
+
+    free(copy);
+    if (total == 0) return -1;
+    *fleet = boats;
+    return total;
+
+fail:
+    free(copy);
+    free(boats);
+    return -1;
+}
+
+boat_spec_t *fleet_uniform(int count, int capacity) {
+    boat_spec_t *boats = malloc(sizeof(boat_spec_t) * count);
+    if (!boats) return NULL;
+    for (int i = 0; i < count; i++) {
+        boats[i].capacity = capacity;
+        boats[i].dist = TRIP_FIXED;
+        boats[i].mean_secs = 0;
+    }
+    return boats;
+}
+
+double trip_sample(const boat_spec_t *boat, unsigned *seed) {
+    switch (boat->dist) {
+        case TRIP_UNIFORM:  // mean +/- 50%
+            return boat->mean_secs * (0.5 + unit_sample(seed));
+        case TRIP_EXP:
+            return -boat->mean_secs * log(1.0 - unit_sample(seed));
+        default:
+            return boat->mean_secs;
+    }
+}
+
+int arrival_parse(const char *spec, arrival_process_t *arrivals) {
+    char kind[16];
+    double rate = 0;
+
+    if (strcmp(spec, "burst") == 0) {
+        arrivals->kind = ARRIVE_BURST;
+        arrivals->rate = 0;
+        return 0;
+    }
+    if (sscanf(spec, "%15[a-z]:%lf", kind, &rate) != 2 || rate <= 0) return -1;
+
+    if (strcmp(kind, "uniform") == 0) arrivals->kind = ARRIVE_UNIFORM;
+    else if (strcmp(kind, "poisson") == 0) arrivals->kind = ARRIVE_POISSON;
+    else return -1;
+    arrivals->rate = rate;
+    return 0;
+}
+
+int dispatch_parse(const char *spec, int *timeout_ms) {
+    int ms;
+
+    if (strcmp(spec, "full") == 0) {
+        *timeout_ms = -1;
+        return 0;
+    }
+    if (sscanf(spec, "timeout:%d", &ms) != 1 || ms < 0) return -1;
+    *timeout_ms = ms;
+    return 0;
+}
+
+double arrival_gap(const arrival_process_t *arrivals, unsigned *seed) {
+    switch (arrivals->kind) {
+        case ARRIVE_UNIFORM:
+            return 1.0 / arrivals->rate;
+        case ARRIVE_POISSON:
+            return -log(1.0 - unit_sample(seed)) / arrivals->rate;
+        default:
+            return 0;
+    }
+}
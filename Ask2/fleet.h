@@ -0,0 +1,45 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+// Κατανομή χρόνου ταξιδιού μιας λέμβου
+typedef enum { TRIP_FIXED, TRIP_UNIFORM, TRIP_EXP } trip_dist_t;
+
+// Λέμβος του στόλου: χωρητικότητα και χρόνος ταξιδιού (μετ' επιστροφής)
+typedef struct boat_spec {
+    int capacity;
+    trip_dist_t dist;
+    double mean_secs;       // Μέσος χρόνος ταξιδιού
+} boat_spec_t;
+
+// Ρυθμός άφιξης επιβατών: όλοι μαζί, σταθερό διάστημα ή Poisson
+typedef enum { ARRIVE_BURST, ARRIVE_UNIFORM, ARRIVE_POISSON } arrival_kind_t;
+
+typedef struct arrival_process {
+    arrival_kind_t kind;
+    double rate;            // Επιβάτες ανά δευτερόλεπτο
+} arrival_process_t;
+
+// Στόλος από ομάδες "COUNTxCAPACITY[:fixed|uniform|exp:MEAN_MS]" χωρισμένες με κόμμα,
+// π.χ. "4x20:exp:50,1x100:fixed:200". Επιστρέφει το πλήθος των λεμβών ή -1
+int fleet_parse(const char *spec, boat_spec_t **fleet);
+
+// Ομοιογενής στόλος χωρίς χρόνο ταξιδιού (η αρχική συμπεριφορά)
+boat_spec_t *fleet_uniform(int count, int capacity);
+
+// Διάρκεια ενός ταξιδιού σε δευτερόλεπτα
+double trip_sample(const boat_spec_t *boat, unsigned *seed);
+
+// "burst", "uniform:RATE" ή "poisson:RATE". Επιστρέφει -1 σε λάθος
+int arrival_parse(const char *spec, arrival_process_t *arrivals);
+
+// Διάστημα μέχρι την επόμενη άφιξη σε δευτερόλεπτα
+double arrival_gap(const arrival_process_t *arrivals, unsigned *seed);
+
+// Πολιτική αναχώρησης: "full" (μόνο γεμάτη, timeout -1) ή "timeout:MS"
+// (γεμάτη ή μετά από MS από την έναρξη της επιβίβασης). Επιστρέφει -1 σε λάθος
+int dispatch_parse(const char *spec, int *timeout_ms);
+
+// Ένας τυχαίος αριθμός στο [0, 1)
+double unit_sample(unsigned *seed);
+
+#endif // FLEET_H
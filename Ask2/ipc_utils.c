@@ -1,40 +1,151 @@
 #include "ipc_utils.h"
 #include <fcntl.h>    // For O_CREAT
 #include <sys/stat.h> // For mode_t
+#include <sys/mman.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
-// Initialize the semaphore using sem_open
-void init_semaphore(sem_t **sem, const char *name, int value) {
-    *sem = sem_open(name, O_CREAT, 0666, value);
-    if (*sem == SEM_FAILED) {
-        perror("Semaphore initialization failed");
-        exit(EXIT_FAILURE);
-    } else {
-        //printf("Semaphore successfully created with value %d.\n", value);
+void ipc_unique_name(char *buf, size_t len, const char *tag) {
+    static atomic_int counter;
+    snprintf(buf, len, "/%s.%d.%d", tag, (int)getpid(), atomic_fetch_add(&counter, 1));
+}
+
+static void *map_region(shm_region_t *region, int fd, size_t size) {
+    region->addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region->addr == MAP_FAILED) {
+        handle_error("Shared memory mapping failed");
+    }
+    region->size = size;
+    return region->addr;
+}
+
+// Create a fresh zero-filled region under a name no other run uses
+void *shm_region_create(shm_region_t *region, const char *tag, size_t size) {
+    ipc_unique_name(region->name, sizeof(region->name), tag);
+
+    int fd = shm_open(region->name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd == -1) {
+        handle_error("Shared memory creation failed");
+    }
+    if (ftruncate(fd, size) == -1) {
+        shm_unlink(region->name);
+        handle_error("Shared memory sizing failed");
+    }
+
+    region->owner = 1;
+    region->linked = 1;
+    return map_region(region, fd, size);
+}
+
+// Map a region another process created, e.g. a boat started separately
+void *shm_region_attach(shm_region_t *region, const char *name, size_t size) {
+    snprintf(region->name, sizeof(region->name), "%s", name);
+
+    int fd = shm_open(region->name, O_RDWR, 0);
+    if (fd == -1) {
+        handle_error("Shared memory attach failed");
+    }
+
+    region->owner = 0;
+    region->linked = 1;
+    return map_region(region, fd, size);
+}
+
+void shm_region_unlink(shm_region_t *region) {
+    if (region->owner && region->linked) {
+        if (shm_unlink(region->name) != 0) {
+            perror("Shared memory unlinking failed");
+        }
+        region->linked = 0;
     }
 }
 
-// Close and unlink the semaphore (proper cleanup)
-void destroy_semaphore(sem_t *sem, const char *name) {
-    if (sem == SEM_FAILED) {
-        perror("Invalid semaphore, cannot close");
-        exit(EXIT_FAILURE);
+void shm_region_destroy(shm_region_t *region) {
+    if (munmap(region->addr, region->size) != 0) {
+        perror("Shared memory unmapping failed");
     }
+    shm_region_unlink(region);
+}
+
+// Unnamed semaphore usable by every process that maps it
+void init_semaphore(sem_t *sem, int value) {
+    if (sem_init(sem, 1, value) != 0) {
+        handle_error("Semaphore initialization failed");
+    }
+}
 
-    // Close the semaphore
-    if (sem_close(sem) != 0) {
-        perror("Semaphore closing failed");
-        exit(EXIT_FAILURE);
-    } else {
-        //printf("Semaphore closed successfully.\n");
+void destroy_semaphore(sem_t *sem) {
+    if (sem_destroy(sem) != 0) {
+        handle_error("Semaphore destruction failed");
     }
+}
+
+void init_shared_mutex(pthread_mutex_t *mutex) {
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    if (pthread_mutex_init(mutex, &attr) != 0) {
+        handle_error("Mutex initialization failed");
+    }
+    pthread_mutexattr_destroy(&attr);
+}
+
+void deadline_in(struct timespec *deadline, int timeout_ms) {
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline->tv_nsec >= 1000000000) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+int sem_wait_until(sem_t *sem, const struct timespec *deadline) {
+    while (sem_timedwait(sem, deadline) != 0) {
+        if (errno == ETIMEDOUT) return -1;
+        if (errno != EINTR) handle_error("Semaphore wait failed");
+    }
+    return 0;
+}
+
+int sem_wait_timeout(sem_t *sem, int timeout_ms) {
+    struct timespec deadline;
+    deadline_in(&deadline, timeout_ms);
+    return sem_wait_until(sem, &deadline);
+}
+
+// Sleep while *addr still holds 'expected'. EAGAIN (value already changed)
+// and EINTR are normal returns: callers re-check their condition in a loop.
+int futex_wait(atomic_int *addr, int expected) {
+    if (syscall(SYS_futex, addr, FUTEX_WAIT, expected, NULL, NULL, 0) == -1
+        && errno != EAGAIN && errno != EINTR) {
+        handle_error("futex wait failed");
+    }
+    return 0;
+}
+
+// The timeout is relative, so a caller that loops recomputes what is left
+int futex_wait_timeout(atomic_int *addr, int expected, int timeout_ms) {
+    struct timespec timeout = { timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000 };
+    if (syscall(SYS_futex, addr, FUTEX_WAIT, expected, &timeout, NULL, 0) == -1) {
+        if (errno == ETIMEDOUT) return -1;
+        if (errno != EAGAIN && errno != EINTR) handle_error("futex wait failed");
+    }
+    return 0;
+}
 
-    // Unlink the semaphore
-    if (sem_unlink(name) != 0) {
-        perror("Semaphore unlinking failed");
-        exit(EXIT_FAILURE);
-    } else {
-        //printf("Semaphore unlinked successfully.\n");
+// Wake up to 'count' waiters on addr. Returns the number woken
+int futex_wake(atomic_int *addr, int count) {
+    long woken = syscall(SYS_futex, addr, FUTEX_WAKE, count, NULL, NULL, 0);
+    if (woken == -1) {
+        handle_error("futex wake failed");
     }
+    return (int)woken;
 }
 
 // Error handling function
@@ -5,10 +5,49 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdatomic.h>
+#include <time.h>
 
-// Δημιουργία και αρχικοποίηση σημαφόρων
-void init_semaphore(sem_t **sem, const char *name, int value);
-void destroy_semaphore(sem_t *sem, const char *name);
+// Περιοχή κοινόχρηστης μνήμης (shm_open/mmap) με μοναδικό όνομα ανά εκτέλεση
+typedef struct shm_region {
+    char name[64];
+    void *addr;
+    size_t size;
+    int owner;      // Η διεργασία που τη δημιούργησε κάνει και το unlink
+    int linked;     // Το όνομα υπάρχει ακόμα στο /dev/shm
+} shm_region_t;
+
+// Μοναδικό όνομα IPC της μορφής "/<tag>.<pid>.<n>"
+void ipc_unique_name(char *buf, size_t len, const char *tag);
+
+// Δημιουργία (μηδενισμένης) περιοχής ή σύνδεση σε υπάρχουσα με το όνομά της
+void *shm_region_create(shm_region_t *region, const char *tag, size_t size);
+void *shm_region_attach(shm_region_t *region, const char *name, size_t size);
+
+// Αφαίρεση του ονόματος: η μνήμη μένει όσο είναι mapped
+void shm_region_unlink(shm_region_t *region);
+
+// munmap και, για τον δημιουργό, unlink
+void shm_region_destroy(shm_region_t *region);
+
+// Ανώνυμοι σημαφόροι και mutex κοινόχρηστοι μεταξύ διεργασιών (pshared)
+void init_semaphore(sem_t *sem, int value);
+void destroy_semaphore(sem_t *sem);
+void init_shared_mutex(pthread_mutex_t *mutex);
+
+// sem_wait με όριο χρόνου σε ms. Επιστρέφει 0, ή -1 αν έληξε ο χρόνος
+int sem_wait_timeout(sem_t *sem, int timeout_ms);
+
+// Απόλυτη προθεσμία (CLOCK_REALTIME) σε timeout_ms από τώρα, και αναμονή ως αυτήν
+void deadline_in(struct timespec *deadline, int timeout_ms);
+int sem_wait_until(sem_t *sem, const struct timespec *deadline);
+
+// Futex: αναμονή όσο *addr == expected και αφύπνιση έως count νημάτων.
+// Λειτουργούν και σε κοινόχρηστη μνήμη μεταξύ διεργασιών
+int futex_wait(atomic_int *addr, int expected);
+// Όπως η futex_wait, με όριο χρόνου σε ms. Επιστρέφει -1 αν έληξε ο χρόνος
+int futex_wait_timeout(atomic_int *addr, int expected, int timeout_ms);
+int futex_wake(atomic_int *addr, int count);
 
 // Βοηθητική συνάρτηση για ασφαλή έξοδο από το πρόγραμμα
 void handle_error(const char *msg);
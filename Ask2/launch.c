@@ -3,88 +3,208 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <limits.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
 #include "ipc_utils.h"
+#include "worker_pool.h"
+#include "simulation.h"
+#include "request_ring.h"
+#include "fleet.h"
+#include "log.h"
 
-#define MAX_PASSENGERS 1000
+#define TASK_QUEUE_SIZE 4096  //Passengers queued for the worker pool at a time
+#define RING_SIZE 4096        //Boarding requests in flight in process mode
+#define PUSH_TIMEOUT_MS 100   //How often the generator checks that the boats are alive
+#define MAX_BOAT_REPORT 20    //Boats listed one by one in the report
+#define IDLE_WAIT_MS 100      //Longest a boat sleeps before re-checking for shutdown
 
-void *passenger(void *arg);  
+void passenger(long passenger_id);
 
-sem_t *boat_semaphore;  
-sem_t *boat_queue;      
-sem_t *boat_ready;      
+shm_region_t region;      //Shared memory holding the simulation state
+shared_state_t *shared;   //Dock and passenger counters inside the region
 
-int num_passengers, num_boats, boat_capacity;
-int remaining_passengers;
-pthread_mutex_t lock;     //Mutex to protect shared variable
+long num_passengers;
+int num_boats, boat_capacity, num_workers;
+int process_mode = 0;     //Boats as forked processes instead of threads
+int service_mode = 0;     //Passengers keep arriving until SIGINT/SIGTERM
 
-void *boat(void *arg) {
-    int *boat_id = (int *)arg;
+volatile sig_atomic_t stop_requested = 0;
 
-    while (remaining_passengers>0) {
-        pthread_mutex_lock(&lock);
-        if (remaining_passengers <= 0) {  //Check if there are remaining passengers
-            pthread_mutex_unlock(&lock);
-            break;
-        }
-        pthread_mutex_unlock(&lock);
+boat_spec_t *fleet;       //Capacity and trip model of every boat
+arrival_process_t arrivals = { ARRIVE_BURST, 0 };
+passenger_info_t *passengers;  //Arrival and class of each passenger in thread mode
+long passenger_window;         //Slots in passengers[]
+int dispatch_timeout_ms = -1;  //Depart full (-1) or after this long at the dock
+double priority_share = 0;     //Share of passengers in the priority class
 
-        printf("Boat %d is ready to board passengers.\n", *boat_id);
+//Ask the generator to stop: no more passengers arrive, everyone already
+//waiting is still transported. A second signal kills the program (SA_RESETHAND);
+//nothing is left in /dev/shm since the region names are unlinked at startup
+void on_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
 
+void install_stop_handlers() {
+    struct sigaction sa;
+    sa.sa_handler = on_stop_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESETHAND;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+}
 
-        pthread_mutex_lock(&lock);
-        int passengers_to_board = remaining_passengers >= boat_capacity ? boat_capacity : remaining_passengers;
-        remaining_passengers -= passengers_to_board;  //remaining passengers after the boat
-        pthread_mutex_unlock(&lock);
+//Only the generator (main thread) handles the stop signals, so its sleeps
+//are the ones they interrupt. Threads and boat processes inherit the mask
+void block_stop_signals(int block) {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    pthread_sigmask(block ? SIG_BLOCK : SIG_UNBLOCK, &set, NULL);
+}
 
-        //release seats
-        for (int i = 0; i < passengers_to_board; i++) {
-            sem_post(boat_semaphore);
-        }
+//More passengers to generate?
+int generating(long next_id) {
+    return !stop_requested && (service_mode || next_id <= num_passengers);
+}
 
-        for (int i = 0; i < passengers_to_board; i++) {
-            sem_post(boat_queue);  // Allow one passenger from the queue
-        }
+void sleep_secs(double secs) {
+    if (secs <= 0) return;
+    struct timespec ts = { (time_t)secs, (long)((secs - (time_t)secs) * 1e9) };
+    while (nanosleep(&ts, &ts) == -1 && !stop_requested) {
+    }
+}
+
+//Pace the generator to the arrival process. clock holds the previous
+//arrival; returns the next one, sleeping until then if we are early.
+//A generator that falls behind does not sleep, so its passengers wait longer.
+double next_arrival(double *clock, unsigned *seed) {
+    *clock += arrival_gap(&arrivals, seed);
+    sleep_secs(*clock - now_secs());
+    return *clock;
+}
+
+//Trip of a boat carrying n passengers
+void sail(int boat_id, int n, unsigned *seed) {
+    boat_stats_t *stats = &shared->boats[boat_id - 1];
+    double trip = trip_sample(&fleet[boat_id - 1], seed);
+
+    sleep_secs(trip);
+    stats->trips++;
+    if (n < stats->capacity) stats->partial_trips++;
+    stats->passengers += n;
+    stats->sailing_secs += trip;
+}
 
-        // Wait for passengers to signal that they are ready
-        for (int i = 0; i < passengers_to_board; i++) {
-            sem_wait(boat_ready);
+//Claim up to max of the passengers waiting for a boat, without a lock.
+//A CAS loop rather than fetch-and-subtract: passengers keep arriving, so
+//the count must never be pushed below zero by a claim
+int claim_passengers(int max) {
+    long waiting = atomic_load(&shared->waiting_passengers);
+    while (waiting > 0) {
+        long take = waiting < max ? waiting : max;
+        if (atomic_compare_exchange_weak(&shared->waiting_passengers, &waiting, waiting - take)) {
+            return (int)take;
         }
+    }
+    return 0;
+}
 
-        printf("--Boat %d is departing with %d passengers.\n", *boat_id, passengers_to_board);
-        //sleep(2);  //Simulate trip
-        printf("Boat %d has returned.\n", *boat_id);
+//A passenger was handed to the worker pool: boats may claim them.
+//Sleeping boats are woken only once enough passengers wait for one of them
+void passenger_arrived() {
+    long waiting = atomic_fetch_add(&shared->waiting_passengers, 1) + 1;
+    atomic_fetch_add(&shared->arrivals, 1);
+    if (waiting >= atomic_load(&shared->wanted)) {
+        atomic_store(&shared->wanted, LONG_MAX);
+        futex_wake(&shared->arrivals, INT_MAX);
+    }
+}
 
-        //printf("----%d passengers remaining!\n", remaining_passengers);
+//A boat about to sleep until 'need' passengers wait
+void want_passengers(long need) {
+    long wanted = atomic_load(&shared->wanted);
+    while (need < wanted && !atomic_compare_exchange_weak(&shared->wanted, &wanted, need)) {
     }
+}
 
-    free(boat_id);
-    return NULL;
+//Poison pill for boat threads: no passenger arrives after this
+void close_arrivals() {
+    atomic_store(&shared->closed, 1);
+    futex_wake(&shared->arrivals, INT_MAX);
 }
 
-int main() {
-    printf("Enter the number of passengers: ");
-    scanf("%d", &num_passengers);
-    printf("Enter the number of boats: ");
-    scanf("%d", &num_boats);
-    printf("Enter the capacity of each boat: ");
-    scanf("%d", &boat_capacity);
-    printf("\n");
+//Gather passengers for the next trip on top of the 'seats' already held.
+//Waits for a full boat, or under a dispatch timeout until the deadline,
+//and returns early once arrivals are closed. 0 means closed and nobody left
+int gather_passengers(int seats, int capacity) {
+    double deadline = 0;
 
-    if (num_passengers > MAX_PASSENGERS) {
-        printf("Error: Maximum number of passengers is %d.\n", MAX_PASSENGERS);
-        return EXIT_FAILURE;
+    while (seats < capacity) {
+        int seen = atomic_load(&shared->arrivals);
+        int closed = atomic_load(&shared->closed);  //Read before claiming: nothing arrives after it
+        seats += claim_passengers(capacity - seats);
+
+        if (seats == capacity || closed) break;
+        if (seats > 0 && dispatch_timeout_ms >= 0) {
+            if (deadline == 0) deadline = now_secs() + dispatch_timeout_ms / 1000.0;
+            if (now_secs() >= deadline) break;
+        }
+
+        //Bounded wait: a missed wake-up costs at most IDLE_WAIT_MS
+        int wait_ms = IDLE_WAIT_MS;
+        if (deadline > 0) {
+            int left = (int)((deadline - now_secs()) * 1000) + 1;
+            if (left < wait_ms) wait_ms = left;
+        }
+        //Under a dispatch timeout the first passenger starts the clock
+        long need = dispatch_timeout_ms >= 0 && seats == 0 ? 1 : capacity - seats;
+        want_passengers(need);
+        if (atomic_load(&shared->arrivals) == seen && atomic_load(&shared->waiting_passengers) < need) {
+            futex_wait_timeout(&shared->arrivals, seen, wait_ms);
+        }
     }
+    return seats;
+}
+
+void *boat(void *arg) {
+    int *boat_id = (int *)arg;
+    int capacity = fleet[*boat_id - 1].capacity;
+    int owed = 0;  //Claimed passengers that missed the last departure
+    unsigned seed = *boat_id;
 
-    remaining_passengers = num_passengers;
-    pthread_mutex_init(&lock, NULL);
+    int seats;
+    while ((seats = gather_passengers(owed, capacity)) > 0) {
+        if (owed > 0) {
+            LOG(LOG_INFO, "Boat %ld is ready to board %ld passengers (%ld carried over).\n", *boat_id, seats, owed);
+        } else {
+            LOG(LOG_INFO, "Boat %ld is ready to board %ld passengers.\n", *boat_id, seats);
+        }
 
-    pthread_t passenger_threads[num_passengers];
-    pthread_t boat_threads[num_boats];
+        //release all seats at once and wait until they fill or the dispatch deadline passes
+        int passengers_to_board = dock_load_boat(&shared->dock, *boat_id, seats, dispatch_timeout_ms);
+        owed = seats - passengers_to_board;
+        if (passengers_to_board == 0) continue;
 
-    //Initialize semaphores
-    init_semaphore(&boat_semaphore, "boatsem", 0);
-    init_semaphore(&boat_queue, "boatqueue", num_passengers);
-    init_semaphore(&boat_ready, "boatready", 0);
+        atomic_fetch_add(&shared->transported, passengers_to_board);
+        LOG(LOG_INFO, "--Boat %ld is departing with %ld passengers.\n", *boat_id, passengers_to_board);
+        sail(*boat_id, passengers_to_board, &seed);
+        LOG(LOG_INFO, "Boat %ld has returned.\n", *boat_id);
+    }
+
+    free(boat_id);
+    return NULL;
+}
+
+//Boats as threads in this process, passengers as tasks on the worker pool
+void run_threads() {
+    pthread_t *boat_threads = malloc(sizeof(pthread_t) * num_boats);
+    if (!boat_threads) handle_error("malloc");
 
     //create boat threads
     for (int i = 0; i < num_boats; i++) {
@@ -93,30 +213,362 @@ int main() {
         pthread_create(&boat_threads[i], NULL, boat, boat_id);
     }
 
-    //create passenger threads
-    for (int i = 0; i < num_passengers; i++) {
-        int *passenger_id = malloc(sizeof(int));
-        *passenger_id = i + 1;
-        pthread_create(&passenger_threads[i], NULL, passenger, passenger_id);
+    //passengers are tasks served by a fixed pool of worker threads.
+    //A queue that holds every seat of the fleet means boats gathering a full
+    //load can never stall the generator on a full queue
+    int queue_size = TASK_QUEUE_SIZE;
+    for (int i = 0, seats = 0; i < num_boats; i++) {
+        seats += fleet[i].capacity;
+        if (seats > queue_size) queue_size = seats;
     }
 
-    //join passenger threads
-    for (int i = 0; i < num_passengers; i++) {
-        pthread_join(passenger_threads[i], NULL);
+    //The window must also hold every seat, or boats waiting for a full load
+    //would hold all of it while the generator waits for a slot
+    passenger_window = queue_size > PASSENGER_WINDOW ? queue_size : PASSENGER_WINDOW;
+    passengers = calloc(passenger_window, sizeof(passenger_info_t));
+    if (!passengers) handle_error("malloc");
+
+    worker_pool_t pool;
+    pool_init(&pool, num_workers, queue_size, passenger);
+    block_stop_signals(0);
+
+    double clock = now_secs();
+    unsigned seed = 0;
+    for (long id = 1; generating(id); id++) {
+        passenger_info_t *info = &passengers[(id - 1) % passenger_window];
+        while (atomic_load(&info->in_use) && !stop_requested) sched_yield();  //Still boarding from a window ago
+
+        double t_arrive = next_arrival(&clock, &seed);
+        if (stop_requested) break;
+        info->t_arrive = t_arrive;
+        info->priority = priority_share > 0 && unit_sample(&seed) < priority_share;
+        atomic_store(&info->in_use, 1);
+        pool_submit(&pool, id, info->priority);
+        passenger_arrived();
     }
+    close_arrivals();
+
+    //wait until every passenger has boarded
+    pool_shutdown(&pool);
 
     //join boat threads
     for (int i = 0; i < num_boats; i++) {
         pthread_join(boat_threads[i], NULL);
     }
+    free(boat_threads);
+    free(passengers);
+}
+
+//Boat process: take batches of boarding requests until the poison pill
+void boat_process(int boat_id, request_ring_t *ring) {
+    int capacity = fleet[boat_id - 1].capacity;
+    unsigned seed = boat_id;
+    boarding_request_t *batch = malloc(sizeof(boarding_request_t) * capacity);
+    if (!batch) handle_error("malloc");
+
+    int done = 0;
+    while (!done) {
+        LOG(LOG_INFO, "Boat %ld is ready to board passengers.\n", boat_id);
+
+        int n = ring_pop_batch(ring, batch, capacity, dispatch_timeout_ms);
+        if (batch[n - 1].passenger_id == NO_MORE_PASSENGERS) {
+            n--;
+            done = 1;
+        }
+
+        if (n > 0) {
+            double boarded = now_secs();
+            for (int i = 0; i < n; i++) {
+                hist_record(&shared->wait, boarded - batch[i].t_arrive);
+                hist_record(&shared->class_wait[0], boarded - batch[i].t_arrive);
+            }
+            atomic_fetch_add(&shared->transported, n);
+            LOG(LOG_INFO, "--Boat %ld is departing with %ld passengers.\n", boat_id, n);
+            sail(boat_id, n, &seed);
+            LOG(LOG_INFO, "Boat %ld has returned.\n", boat_id);
+        }
+    }
+
+    free(batch);
+    log_stop();
+    fflush(stdout);
+    _exit(EXIT_SUCCESS);
+}
+
+//Reap boats that have exited. Before the pills any exit is a crash,
+//after them only an unclean one is
+int boat_crashed(int pills_sent) {
+    int status;
+    while (waitpid(-1, &status, WNOHANG) > 0) {
+        if (!pills_sent || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) return 1;
+    }
+    return 0;
+}
+
+//Boats as forked processes fed by this process through a shared-memory ring.
+//Returns -1 if a boat died before the run was complete.
+int run_processes() {
+    shm_region_t ring_region;
+    request_ring_t *ring = shm_region_create(&ring_region, "boatring", ring_size(RING_SIZE));
+    ring_init(ring, RING_SIZE);
+
+    //Children inherit the mapping, so the name can go now
+    shm_region_unlink(&ring_region);
+
+    pid_t *boats = malloc(sizeof(pid_t) * num_boats);
+    if (!boats) handle_error("malloc");
+
+    pid_t generator = getpid();
+    log_stop();      //The writer thread does not survive fork: each boat starts its own
+    fflush(stdout);  //Do not let the children repeat buffered output
+    for (int i = 0; i < num_boats; i++) {
+        boats[i] = fork();
+        if (boats[i] == -1) handle_error("fork");
+        if (boats[i] == 0) {
+            prctl(PR_SET_PDEATHSIG, SIGKILL);  //A boat dies with the generator
+            if (getppid() != generator) _exit(EXIT_FAILURE);
+            log_start();  //The stop signals stay blocked: the generator shuts the boats down
+            boat_process(i + 1, ring);
+        }
+    }
+    block_stop_signals(0);
+
+    //Generate the passengers until done or asked to stop, then one poison
+    //pill per boat. Boats only exit after a pill, so an earlier exit is a
+    //crash: check for one every ring's worth of requests and whenever the
+    //ring stays full (a bounded wait, so a stop request is seen as well)
+    int failed = 0, status;
+    double clock = now_secs();
+    unsigned seed = 0;
+    long id = 1, pills = 0;
+    while (!failed && pills < num_boats) {
+        boarding_request_t req = { NO_MORE_PASSENGERS, 0 };
+        if (generating(id)) {
+            req.t_arrive = next_arrival(&clock, &seed);
+            if (!stop_requested) req.passenger_id = id++;
+        }
+        if (req.passenger_id == NO_MORE_PASSENGERS) pills++;
+
+        if (id % RING_SIZE == 0 && boat_crashed(pills > 0)) {
+            failed = 1;
+        }
+        while (!failed && ring_push(ring, &req, PUSH_TIMEOUT_MS) != 0) {
+            failed = boat_crashed(pills > 0);
+        }
+    }
+
+    if (failed) {
+        printf("Error: a boat process died, stopping the simulation.\n");
+        for (int i = 0; i < num_boats; i++) kill(boats[i], SIGKILL);
+    }
 
-    //Destroy semaphores
-    destroy_semaphore(boat_semaphore, "boatsem");
-    destroy_semaphore(boat_queue, "boatqueue");
-    destroy_semaphore(boat_ready, "boatready");
+    for (int i = 0; i < num_boats; i++) {
+        if (waitpid(boats[i], &status, 0) == boats[i]
+            && (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)) {
+            failed = 1;
+        }
+    }
+    free(boats);
+
+    ring_destroy(ring);
+    shm_region_destroy(&ring_region);
+    return failed ? -1 : 0;
+}
+
+//Wait-time percentiles, boat utilization and evacuation time
+void print_wait(const char *label, latency_hist_t *wait) {
+    printf("%s (ms): mean %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n", label,
+           hist_mean(wait) * 1e3, hist_percentile(wait, 50) * 1e3, hist_percentile(wait, 90) * 1e3,
+           hist_percentile(wait, 99) * 1e3, hist_max(wait) * 1e3);
+}
 
-    pthread_mutex_destroy(&lock);
+void print_report(double elapsed) {
+    printf("Evacuation time: %.3f s\n", elapsed);
+    print_wait("Passenger wait", &shared->wait);
+    if (priority_share > 0) {
+        print_wait("  priority", &shared->class_wait[1]);
+        print_wait("  regular", &shared->class_wait[0]);
+    }
+
+    //Seats: share of offered seats that were filled. Sailing: share of the run spent on trips
+    long seats = 0, carried = 0, trips = 0, partial = 0;
+    double sailing = 0;
+    for (int i = 0; i < num_boats; i++) {
+        boat_stats_t *b = &shared->boats[i];
+        trips += b->trips;
+        partial += b->partial_trips;
+        seats += b->trips * b->capacity;
+        carried += b->passengers;
+        sailing += b->sailing_secs;
+        if (num_boats <= MAX_BOAT_REPORT) {
+            printf("  Boat %d: capacity %d, %ld trips, %ld passengers, %.1f%% seats, %.1f%% sailing\n",
+                   i + 1, b->capacity, b->trips, b->passengers,
+                   b->trips ? 100.0 * b->passengers / (b->trips * b->capacity) : 0,
+                   elapsed > 0 ? 100.0 * b->sailing_secs / elapsed : 0);
+        }
+    }
+    printf("Fleet utilization: %.1f%% seats, %.1f%% sailing\n",
+           seats ? 100.0 * carried / seats : 0,
+           elapsed > 0 ? 100.0 * sailing / (elapsed * num_boats) : 0);
+
+    if (dispatch_timeout_ms < 0) {
+        printf("Dispatch full: ");
+    } else {
+        printf("Dispatch timeout %d ms: ", dispatch_timeout_ms);
+    }
+    printf("%ld trips (%ld partial), %.1f trips/s, %.1f passengers per trip\n",
+           trips, partial, trips / (elapsed > 0 ? elapsed : 1e-9), trips ? (double)carried / trips : 0);
+}
+
+int main(int argc, char *argv[]) {
+    num_workers = pool_default_threads();
+    const char *fleet_spec = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "PSF:A:d:C:L:")) != -1) {
+        switch (opt) {
+            case 'P': process_mode = 1; break;
+            case 'S': service_mode = 1; break;
+            case 'F': fleet_spec = optarg; break;
+            case 'A':
+                if (arrival_parse(optarg, &arrivals) != 0) {
+                    printf("Error: arrivals must be burst, uniform:RATE or poisson:RATE.\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'd':
+                if (dispatch_parse(optarg, &dispatch_timeout_ms) != 0) {
+                    printf("Error: dispatch policy must be full or timeout:MS.\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'L':
+                if (log_parse_level(optarg, &log_level) != 0) {
+                    printf("Error: log level must be off, error, info or debug.\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'C':
+                priority_share = atof(optarg);
+                if (priority_share < 0 || priority_share > 1) {
+                    printf("Error: the priority share must be between 0 and 1.\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                printf("Usage: %s [-P] [-S] [-A arrivals] [-d dispatch] [-C share] [-L level] [<passengers> <boats> <capacity> [workers]]\n"
+                       "       %s [-P] [-S] [-A arrivals] [-d dispatch] [-C share] [-L level] -F fleet [<passengers> [workers]]\n",
+                       argv[0], argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+
+    //Boat processes take requests in ring order, there is no pool to reorder them
+    if (process_mode && priority_share > 0) {
+        printf("Error: priority boarding (-C) needs thread mode.\n");
+        return EXIT_FAILURE;
+    }
+
+    if (fleet_spec) {
+        //The fleet gives the boats and their capacities
+        num_boats = fleet_parse(fleet_spec, &fleet);
+        if (num_boats < 0) {
+            printf("Error: fleet must look like COUNTxCAPACITY[:fixed|uniform|exp:MEAN_MS],...\n");
+            return EXIT_FAILURE;
+        }
+        boat_capacity = fleet[0].capacity;
+        if (argc >= 2) {
+            // launch -F <fleet> <passengers> [workers]
+            num_passengers = atol(argv[1]);
+            if (argc >= 3) num_workers = atoi(argv[2]);
+        } else {
+            printf("Enter the number of passengers: ");
+            scanf("%ld", &num_passengers);
+            printf("\n");
+        }
+    } else if (argc >= 4) {
+        // launch <passengers> <boats> <capacity> [workers]
+        num_passengers = atol(argv[1]);
+        num_boats = atoi(argv[2]);
+        boat_capacity = atoi(argv[3]);
+        if (argc >= 5) num_workers = atoi(argv[4]);
+    } else {
+        printf("Enter the number of passengers: ");
+        scanf("%ld", &num_passengers);
+        printf("Enter the number of boats: ");
+        scanf("%d", &num_boats);
+        printf("Enter the capacity of each boat: ");
+        scanf("%d", &boat_capacity);
+        printf("\n");
+    }
+
+    if (service_mode) num_passengers = 0;  //Unlimited: the count is ignored
+    if ((num_passengers <= 0 && !service_mode) || num_boats <= 0 || boat_capacity <= 0 || num_workers <= 0) {
+        printf("Error: passengers, boats, capacity and workers must be positive.\n");
+        return EXIT_FAILURE;
+    }
+    if (!fleet) {
+        fleet = fleet_uniform(num_boats, boat_capacity);
+        if (!fleet) handle_error("malloc");
+    }
+
+    //Shared state lives in a per-run shared memory region. Threads and forked
+    //boats only need the mapping, so the name goes at once: no IPC object
+    //outlives the run, however it ends
+    shared = shm_region_create(&region, "boats", sizeof(shared_state_t) + sizeof(boat_stats_t) * num_boats);
+    shm_region_unlink(&region);
+    dock_init(&shared->dock);
+    atomic_init(&shared->waiting_passengers, 0);
+    atomic_init(&shared->arrivals, 0);
+    atomic_init(&shared->wanted, LONG_MAX);
+    atomic_init(&shared->closed, 0);
+    atomic_init(&shared->transported, 0);
+    hist_init(&shared->wait);
+    hist_init(&shared->class_wait[0]);
+    hist_init(&shared->class_wait[1]);
+    for (int i = 0; i < num_boats; i++) {
+        shared->boats[i].capacity = fleet[i].capacity;
+    }
+
+    install_stop_handlers();
+    block_stop_signals(1);  //Until the boats exist; the generator unblocks them
+    log_start();
+    double start = now_secs();
+    int result = 0;
+    if (process_mode) {
+        result = run_processes();
+    } else {
+        run_threads();
+    }
+    double elapsed = now_secs() - start;
+    log_stop();
+    if (log_dropped() > 0) {
+        printf("Log: %ld records dropped, the log rings were full.\n", log_dropped());
+    }
+
+    long transported = atomic_load(&shared->transported);
+    if (result == 0) {
+        printf("Transported %ld passengers in %.3f s (%.0f passengers/s) using %d boat %s.\n",
+               transported, elapsed, transported / (elapsed > 0 ? elapsed : 1e-9),
+               num_boats, process_mode ? "processes" : "threads");
+        print_report(elapsed);
+    }
+
+    dock_destroy(&shared->dock);
+    shm_region_destroy(&region);
+    free(fleet);
+
+    if (result != 0) {
+        printf("Only %ld of %ld passengers were transported.\n", transported, num_passengers);
+        return EXIT_FAILURE;
+    }
+    if (stop_requested) {
+        printf("Stopped on request: every passenger that had arrived was transported.\n");
+        return service_mode ? 0 : EXIT_FAILURE;
+    }
 
     printf("All passengers have been transported. Program exiting.\n");
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,31 @@
+#ifndef LOG_H
+#define LOG_H
+
+// Επίπεδα καταγραφής: με LOG_OFF δεν γράφεται τίποτα
+typedef enum { LOG_OFF, LOG_ERROR, LOG_INFO, LOG_DEBUG } log_level_t;
+
+extern log_level_t log_level;
+
+// Κάθε νήμα γράφει σε δικό του κυκλικό buffer χωρίς κλειδώματα και ένα νήμα
+// στο παρασκήνιο μορφοποιεί τις εγγραφές στο stdout. Η σειρά διατηρείται ανά
+// νήμα. Αν ένα buffer γεμίσει, οι εγγραφές του χάνονται και μετρώνται
+#define LOG(level, ...) \
+    do { if ((level) <= log_level) log_write((level), __VA_ARGS__, 0L, 0L, 0L); } while (0)
+
+// "off", "error", "info" ή "debug". Επιστρέφει -1 σε λάθος
+int log_parse_level(const char *name, log_level_t *level);
+
+// Εκκίνηση του νήματος εγγραφής. Πριν από fork πρέπει να σταματήσει,
+// και η νέα διεργασία ξεκινά το δικό της
+void log_start(void);
+
+// Άδειασμα όλων των buffers και τερματισμός του νήματος εγγραφής
+void log_stop(void);
+
+// Εγγραφές που χάθηκαν επειδή το buffer ήταν γεμάτο
+long log_dropped(void);
+
+// Έως τρία ορίσματα long για το fmt, τα υπόλοιπα αγνοούνται (χρησιμοποιήστε το LOG)
+void log_write(log_level_t level, const char *fmt, long a, long b, long c, ...);
+
+#endif // LOG_H
@@ -4,23 +4,19 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include "ipc_utils.h"
+#include "simulation.h"
+#include "log.h"
 
-extern sem_t *boat_semaphore;     // Έλεγχος για τις διαθέσιμες θέσεις στη λέμβο
-extern sem_t *boat_queue;        // Ουρά για επιβάτες που περιμένουν να επιβιβαστούν
-extern sem_t *boat_ready;        // Σηματοδότηση ότι η λέμβος είναι έτοιμη να αναχωρήσει
+// Εργασία ενός επιβάτη, εκτελείται από ένα νήμα του worker pool
+void passenger(long passenger_id) {
+    LOG(LOG_DEBUG, "Passenger %ld is waiting to board.\n", passenger_id);
 
-void *passenger(void *arg) {
-    int passenger_id = *(int *)arg;
+    int boat_id = dock_board(&shared->dock);  // Take a seat on the boat at the dock
+    passenger_info_t *info = &passengers[(passenger_id - 1) % passenger_window];
+    double wait = now_secs() - info->t_arrive;
+    hist_record(&shared->wait, wait);
+    hist_record(&shared->class_wait[info->priority], wait);
+    atomic_store(&info->in_use, 0);  // The generator may reuse the slot
 
-    printf("Passenger %d is waiting to board.\n", passenger_id);
-
-    //sem_wait(boat_queue);      // Wait for the boat to signal availability
-    sem_wait(boat_semaphore);  // Attempt to board
-
-    printf("Passenger %d boarded the boat.\n", passenger_id);
-
-    sem_post(boat_ready);      // Signal the boat that a passenger has boarded
-
-    free(arg);
-    return NULL;
-}
\ No newline at end of file
+    LOG(LOG_DEBUG, "Passenger %ld boarded boat %ld.\n", passenger_id, boat_id);
+}
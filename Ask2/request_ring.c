@@ -0,0 +1,80 @@
+#include "request_ring.h"
+#include "ipc_utils.h"
+#include <errno.h>
+
+size_t ring_size(int capacity) {
+    return sizeof(request_ring_t) + sizeof(boarding_request_t) * capacity;
+}
+
+void ring_init(request_ring_t *ring, int capacity) {
+    init_semaphore(&ring->slots_free, capacity);
+    init_semaphore(&ring->slots_used, 0);
+    init_shared_mutex(&ring->lock);
+    ring->head = 0;
+    ring->tail = 0;
+    ring->capacity = capacity;
+}
+
+void ring_destroy(request_ring_t *ring) {
+    destroy_semaphore(&ring->slots_free);
+    destroy_semaphore(&ring->slots_used);
+    pthread_mutex_destroy(&ring->lock);
+}
+
+int ring_push(request_ring_t *ring, const boarding_request_t *req, int timeout_ms) {
+    if (sem_wait_timeout(&ring->slots_free, timeout_ms) != 0) {
+        return -1;
+    }
+    ring->slots[ring->tail % ring->capacity] = *req;
+    ring->tail++;
+    sem_post(&ring->slots_used);
+    return 0;
+}
+
+// Read 'reserved' requests we hold slots_used for, stopping after a poison pill.
+// Returns how many were read
+static int read_reserved(request_ring_t *ring, boarding_request_t *out, int reserved) {
+    int taken = 0;
+    pthread_mutex_lock(&ring->lock);
+    while (taken < reserved) {
+        out[taken] = ring->slots[ring->head % ring->capacity];
+        ring->head++;
+        if (out[taken++].passenger_id == NO_MORE_PASSENGERS) break;
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    // Hand back what we reserved but did not take, then free the slots we read
+    for (int i = taken; i < reserved; i++) {
+        sem_post(&ring->slots_used);
+    }
+    for (int i = 0; i < taken; i++) {
+        sem_post(&ring->slots_free);
+    }
+    return taken;
+}
+
+int ring_pop_batch(request_ring_t *ring, boarding_request_t *out, int max, int wait_ms) {
+    struct timespec deadline;
+    int taken = 0, reserved = 1;
+
+    while (sem_wait(&ring->slots_used) != 0) {}  // Retry on EINTR
+    if (wait_ms > 0) deadline_in(&deadline, wait_ms);  // Counted from the first passenger
+
+    while (1) {
+        while (taken + reserved < max && sem_trywait(&ring->slots_used) == 0) {
+            reserved++;
+        }
+        taken += read_reserved(ring, out + taken, reserved);
+
+        // Never wait past a pill: nothing is pushed after the pills
+        if (taken == max || out[taken - 1].passenger_id == NO_MORE_PASSENGERS || wait_ms == 0) break;
+
+        if (wait_ms < 0) {
+            while (sem_wait(&ring->slots_used) != 0) {}
+        } else if (sem_wait_until(&ring->slots_used, &deadline) != 0) {
+            break;
+        }
+        reserved = 1;
+    }
+    return taken;
+}
@@ -0,0 +1,42 @@
+#ifndef REQUEST_RING_H
+#define REQUEST_RING_H
+
+#include <semaphore.h>
+#include <pthread.h>
+#include <stddef.h>
+
+#define NO_MORE_PASSENGERS (-1L)   // passenger_id του poison pill
+
+// Αίτημα επιβίβασης που γράφει η γεννήτρια επιβατών
+typedef struct boarding_request {
+    long passenger_id;
+    double t_arrive;        // Χρόνος άφιξης (δευτερόλεπτα)
+} boarding_request_t;
+
+// Κυκλική ουρά αιτημάτων σε κοινόχρηστη μνήμη: ένας παραγωγός, πολλές λέμβοι
+typedef struct request_ring {
+    sem_t slots_free;
+    sem_t slots_used;
+    pthread_mutex_t lock;   // Σειριοποιεί τις λέμβους που διαβάζουν
+    long head;              // Επόμενο αίτημα προς ανάγνωση (υπό lock)
+    long tail;              // Επόμενη ελεύθερη θέση (μόνο ο παραγωγός)
+    int capacity;
+    boarding_request_t slots[];
+} request_ring_t;
+
+// Μέγεθος μνήμης για ουρά με capacity θέσεις
+size_t ring_size(int capacity);
+
+void ring_init(request_ring_t *ring, int capacity);
+void ring_destroy(request_ring_t *ring);
+
+// Προσθήκη αιτήματος. Επιστρέφει -1 αν δεν ελευθερώθηκε θέση σε timeout_ms
+int ring_push(request_ring_t *ring, const boarding_request_t *req, int timeout_ms);
+
+// Λήψη έως max αιτημάτων (μπλοκάρει για το πρώτο). Μετά το πρώτο περιμένει
+// για τα υπόλοιπα έως wait_ms (0: παίρνει μόνο όσα υπάρχουν, < 0: ως το max).
+// Η λήψη σταματά μετά από poison pill, ώστε κάθε λέμβος να παίρνει το πολύ ένα.
+// Επιστρέφει το πλήθος
+int ring_pop_batch(request_ring_t *ring, boarding_request_t *out, int max, int wait_ms);
+
+#endif // REQUEST_RING_H
@@ -0,0 +1,41 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "boarding.h"
+#include "stats.h"
+
+// Κοινόχρηστη κατάσταση της προσομοίωσης σε περιοχή shm_open/mmap,
+// ώστε λέμβοι και επιβάτες να μπορούν να τρέχουν και σε χωριστές διεργασίες
+typedef struct shared_state {
+    dock_t dock;                       // Αποβάθρα επιβίβασης
+    atomic_long waiting_passengers;    // Επιβάτες που έφτασαν και δεν έχουν λέμβο
+    atomic_int arrivals;               // Futex: αυξάνεται σε κάθε άφιξη
+    atomic_long wanted;                // Ελάχιστοι επιβάτες που χρειάζεται μια λέμβος που κοιμάται
+    atomic_int closed;                 // Poison pill για τις λέμβους-νήματα: τέλος αφίξεων
+    atomic_long transported;           // Επιβάτες που αναχώρησαν (από κάθε διεργασία)
+    latency_hist_t wait;               // Αναμονή επιβατών από την άφιξη ως την επιβίβαση
+    latency_hist_t class_wait[2];      // Η ίδια αναμονή για κανονικούς (0) και προτεραιότητας (1)
+    boat_stats_t boats[];              // Στατιστικά ανά λέμβο (boats[id - 1])
+} shared_state_t;
+
+extern shared_state_t *shared;
+
+// Επιβάτες σε εξέλιξη που παρακολουθεί η γεννήτρια (η προσομοίωση μπορεί να
+// τρέχει χωρίς τέλος, οπότε δεν κρατάμε πίνακα για όλους). Το παράθυρο έχει
+// τουλάχιστον τόσες θέσεις όσες ο στόλος
+#define PASSENGER_WINDOW 65536
+
+// Επιβάτης όπως τον βλέπει η γεννήτρια: άφιξη και κατηγορία
+typedef struct passenger_info {
+    double t_arrive;
+    int priority;           // Ηλικιωμένος ή πλήρωμα: επιβιβάζεται πρώτος
+    atomic_int in_use;      // Η θέση ανήκει σε επιβάτη που δεν έχει επιβιβαστεί
+} passenger_info_t;
+
+// Επιβάτες σε εξέλιξη (passengers[(id - 1) % passenger_window]), μόνο με λέμβους-νήματα
+extern passenger_info_t *passengers;
+extern long passenger_window;
+
+#endif // SIMULATION_H
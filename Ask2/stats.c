@@ -0,0 +1,69 @@
+#include "stats.h"
+#include <time.h>
+
+double now_secs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Bucket index of a value in microseconds
+static int bucket_of(unsigned long us) {
+    if (us < HIST_SUB_BUCKETS) return (int)us;
+    int e = 63 - __builtin_clzl(us);  // e >= 3
+    return (e - 2) * HIST_SUB_BUCKETS + (int)((us >> (e - 3)) & (HIST_SUB_BUCKETS - 1));
+}
+
+// Upper bound (exclusive) of a bucket in microseconds
+static unsigned long bucket_limit(int index) {
+    if (index < HIST_SUB_BUCKETS) return index + 1;
+    int e = index / HIST_SUB_BUCKETS + 2;
+    unsigned long sub = index % HIST_SUB_BUCKETS;
+    return (HIST_SUB_BUCKETS + sub + 1) << (e - 3);
+}
+
+void hist_init(latency_hist_t *hist) {
+    for (int i = 0; i < HIST_BUCKETS; i++) atomic_init(&hist->counts[i], 0);
+    atomic_init(&hist->total, 0);
+    atomic_init(&hist->sum_us, 0);
+    atomic_init(&hist->max_us, 0);
+}
+
+void hist_record(latency_hist_t *hist, double secs) {
+    long us = secs > 0 ? (long)(secs * 1e6) : 0;
+
+    atomic_fetch_add_explicit(&hist->counts[bucket_of(us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->total, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->sum_us, us, memory_order_relaxed);
+
+    long max = atomic_load_explicit(&hist->max_us, memory_order_relaxed);
+    while (us > max && !atomic_compare_exchange_weak(&hist->max_us, &max, us)) {
+    }
+}
+
+double hist_percentile(latency_hist_t *hist, double p) {
+    long total = atomic_load(&hist->total);
+    if (total == 0) return 0;
+
+    long rank = (long)(p / 100.0 * total + 0.5);
+    if (rank < 1) rank = 1;
+
+    long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += atomic_load(&hist->counts[i]);
+        if (seen >= rank) {
+            double limit = bucket_limit(i) / 1e6;
+            return limit < hist_max(hist) ? limit : hist_max(hist);
+        }
+    }
+    return hist_max(hist);
+}
+
+double hist_mean(latency_hist_t *hist) {
+    long total = atomic_load(&hist->total);
+    return total ? atomic_load(&hist->sum_us) / 1e6 / total : 0;
+}
+
+double hist_max(latency_hist_t *hist) {
+    return atomic_load(&hist->max_us) / 1e6;
+}
@@ -0,0 +1,39 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdatomic.h>
+
+// Κάδοι: ακριβείς έως 8 μs και μετά 8 υποδιαιρέσεις ανά δύναμη του 2 (σφάλμα <= 12.5%)
+#define HIST_SUB_BUCKETS 8
+#define HIST_BUCKETS (64 * HIST_SUB_BUCKETS)
+
+// Ιστόγραμμα χρόνων σε μs. Ατομικοί μετρητές, ώστε να γράφουν σε αυτό
+// νήματα και διεργασίες ταυτόχρονα (όταν βρίσκεται σε κοινόχρηστη μνήμη)
+typedef struct latency_hist {
+    atomic_long counts[HIST_BUCKETS];
+    atomic_long total;
+    atomic_long sum_us;
+    atomic_long max_us;
+} latency_hist_t;
+
+// Στατιστικά μίας λέμβου. Τα γράφει μόνο η ίδια η λέμβος
+typedef struct boat_stats {
+    int capacity;
+    long trips;
+    long partial_trips;     // Ταξίδια με κενές θέσεις
+    long passengers;
+    double sailing_secs;    // Χρόνος εκτός αποβάθρας (ταξίδια)
+} boat_stats_t;
+
+// Χρόνος CLOCK_MONOTONIC σε δευτερόλεπτα, κοινός για όλες τις διεργασίες
+double now_secs(void);
+
+void hist_init(latency_hist_t *hist);
+void hist_record(latency_hist_t *hist, double secs);
+
+// Τιμή (σε δευτερόλεπτα) κάτω από την οποία βρίσκεται το ποσοστό p (0-100)
+double hist_percentile(latency_hist_t *hist, double p);
+double hist_mean(latency_hist_t *hist);
+double hist_max(latency_hist_t *hist);
+
+#endif // STATS_H
@@ -0,0 +1,107 @@
+#include "worker_pool.h"
+#include "ipc_utils.h"
+#include <unistd.h>
+
+int pool_default_threads(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+}
+
+// Priority tasks go first, but a waiting normal task gets its turn after
+// POOL_PRIORITY_BURST priority tasks in a row. Called with the lock held
+static task_queue_t *pick_queue(worker_pool_t *pool) {
+    task_queue_t *normal = &pool->queues[0], *priority = &pool->queues[1];
+
+    if (priority->count > 0 && (normal->count == 0 || pool->priority_run < POOL_PRIORITY_BURST)) {
+        pool->priority_run++;
+        return priority;
+    }
+    pool->priority_run = 0;
+    return normal->count > 0 ? normal : NULL;
+}
+
+// Worker loop: take task ids off the queues until shutdown and both are drained
+static void *pool_worker(void *arg) {
+    worker_pool_t *pool = (worker_pool_t *)arg;
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        task_queue_t *queue;
+        while ((queue = pick_queue(pool)) == NULL && !pool->shutdown) {
+            pthread_cond_wait(&pool->not_empty, &pool->lock);
+        }
+        if (queue == NULL) {  // shutdown and nothing left to run
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+
+        long id = queue->ids[queue->head];
+        queue->head = (queue->head + 1) % pool->capacity;
+        queue->count--;
+        pthread_cond_signal(&pool->not_full);
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->fn(id);
+    }
+
+    return NULL;
+}
+
+void pool_init(worker_pool_t *pool, int num_threads, int capacity, task_fn fn) {
+    pool->num_threads = num_threads;
+    pool->capacity = capacity;
+    pool->priority_run = 0;
+    pool->shutdown = 0;
+    pool->fn = fn;
+
+    for (int q = 0; q < 2; q++) {
+        pool->queues[q].ids = malloc(sizeof(long) * capacity);
+        pool->queues[q].head = 0;
+        pool->queues[q].count = 0;
+    }
+    pool->threads = malloc(sizeof(pthread_t) * num_threads);
+    if (!pool->queues[0].ids || !pool->queues[1].ids || !pool->threads) {
+        handle_error("Worker pool allocation failed");
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->not_empty, NULL);
+    pthread_cond_init(&pool->not_full, NULL);
+
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, pool_worker, pool) != 0) {
+            handle_error("Worker thread creation failed");
+        }
+    }
+}
+
+void pool_submit(worker_pool_t *pool, long id, int priority) {
+    task_queue_t *queue = &pool->queues[priority ? 1 : 0];
+
+    pthread_mutex_lock(&pool->lock);
+    while (queue->count == pool->capacity) {
+        pthread_cond_wait(&pool->not_full, &pool->lock);
+    }
+    queue->ids[(queue->head + queue->count) % pool->capacity] = id;
+    queue->count++;
+    pthread_cond_signal(&pool->not_empty);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void pool_shutdown(worker_pool_t *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->not_empty);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->not_empty);
+    pthread_cond_destroy(&pool->not_full);
+    free(pool->queues[0].ids);
+    free(pool->queues[1].ids);
+    free(pool->threads);
+}
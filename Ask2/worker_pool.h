@@ -0,0 +1,49 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+
+// Μετά από τόσες εργασίες προτεραιότητας στη σειρά εξυπηρετείται μία κανονική,
+// ώστε οι κανονικές εργασίες να μη λιμοκτονούν
+#define POOL_PRIORITY_BURST 4
+
+// Εργασία που εκτελεί ένα νήμα του pool για ένα αναγνωριστικό (π.χ. επιβάτη)
+typedef void (*task_fn)(long id);
+
+// Φραγμένη κυκλική ουρά αναγνωριστικών
+typedef struct task_queue {
+    long *ids;
+    int head;
+    int count;
+} task_queue_t;
+
+// Σταθερός αριθμός νημάτων που εξυπηρετούν δύο ουρές εργασιών:
+// κανονική (0) και προτεραιότητας (1)
+typedef struct worker_pool {
+    pthread_t *threads;
+    int num_threads;
+
+    task_queue_t queues[2];
+    int capacity;           // Θέσεις κάθε ουράς
+    int priority_run;       // Εργασίες προτεραιότητας που εξυπηρετήθηκαν στη σειρά
+    int shutdown;
+
+    task_fn fn;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} worker_pool_t;
+
+// Αριθμός νημάτων ίσος με τους διαθέσιμους πυρήνες
+int pool_default_threads(void);
+
+void pool_init(worker_pool_t *pool, int num_threads, int capacity, task_fn fn);
+
+// Προσθήκη εργασίας στην κανονική ουρά ή (priority != 0) στην ουρά
+// προτεραιότητας. Μπλοκάρει όσο η ουρά είναι γεμάτη
+void pool_submit(worker_pool_t *pool, long id, int priority);
+
+// Εκτέλεση όσων εργασιών απομένουν, τερματισμός των νημάτων και αποδέσμευση
+void pool_shutdown(worker_pool_t *pool);
+
+#endif // WORKER_POOL_H
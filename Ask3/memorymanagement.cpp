@@ -1,8 +1,19 @@
 #include <iostream>
+#include <fstream>
 #include <queue>
+#include <deque>
 #include <vector>
 #include <iomanip>
 #include <limits>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <chrono>
+#include <getopt.h>
 
 using namespace std;
 
@@ -13,6 +24,10 @@ struct Process {
     int remaining_time;
     int memory_needed;
     bool in_memory;
+    int load_time;      // Time the process got its memory (-1 until loaded)
+    int finish_time;
+    long seq;           // Position in the trace, used to keep waiters in input order
+    long arrival_event; // Scheduling event at which the process started waiting
 };
 
 struct MemoryBlock {
@@ -24,21 +39,374 @@ struct MemoryBlock {
     MemoryBlock(int s, int sz, bool f, int p) : start(s), size(sz), free(f), pid(p) {}
 };
 
-const int TOTAL_MEMORY = 512;  // Total memory in KB
-const int TIME_QUANTUM = 3;    // Time quantum for Round Robin
+enum Policy { FIRST_FIT, BEST_FIT, WORST_FIT, NEXT_FIT };
+const char* policy_names[] = { "first", "best", "worst", "next" };
+
+int total_memory = 512;        // Total memory in KB
+int time_quantum = 3;          // Time quantum for Round Robin
+Policy policy = FIRST_FIT;     // Placement policy for allocate_memory()
+size_t next_fit_index = 0;     // Where the next-fit search resumes
 
 vector<MemoryBlock> memory;    // Memory blocks
-queue<int> ready_queue;        // Queue contains indices of processes
-vector<Process> processes;
+vector<Process> processes;     // Slots of the processes currently in the system
+vector<int> free_slots;        // Slots of finished processes, reused for new arrivals
+
+int log_interval = 1;          // Log every N-th scheduling event (0 disables logging)
+
+// Each CPU runs Round Robin over its own ready queue. Loaded processes go to
+// the least loaded CPU and an idle CPU with nothing queued steals work.
+struct Core {
+    deque<int> ready_queue;    // Queue contains slots of processes
+    int running;               // Slot on the CPU, -1 when idle
+    int slice_end;             // Time the running slice ends
+    int shown_pid;             // Process whose slice just ended, for the log (-1 if none)
+    int shown_remaining;
+    long busy_time;
+    long memory_stall_time;    // Idle (or compacting) while processes wait for memory
+    long idle_time;            // Idle with no process waiting anywhere
+    long slices;
+    long migrations;           // Processes stolen from another CPU's queue
+
+    Core() : running(-1), slice_end(0), shown_pid(-1), shown_remaining(0), busy_time(0),
+             memory_stall_time(0), idle_time(0), slices(0), migrations(0) {}
+
+    size_t load() const { return ready_queue.size() + (running >= 0 ? 1 : 0); }
+};
+
+int num_cpus = 1;
+bool work_stealing = true;
+vector<Core> cores;
+
+struct Arrival {
+    int time;
+    long seq;
+    int slot;
+
+    bool operator>(const Arrival& other) const {
+        return time != other.time ? time > other.time : seq > other.seq;
+    }
+};
+priority_queue<Arrival, vector<Arrival>, greater<Arrival> > arrivals;  // Processes read but not yet arrived
+
+typedef pair<long, int> Waiter;  // (trace position, slot)
+
+// Arrived processes still waiting for memory. Waiters are bucketed by size and
+// a min-tree over the sizes gives the earliest waiter that fits a hole, so
+// admission does not rescan a long backlog after every free. The tree only
+// has nodes on the paths to sizes someone is waiting for, so it stays small
+// however large memory is.
+class WaitingSet {
+public:
+    void reset(int max_need) {
+        leaves = 1;
+        while (leaves < (size_t)max_need + 1) leaves <<= 1;
+        nodes.assign(1, Node());
+        free_nodes.clear();
+        buckets.clear();
+        count = 0;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void insert(const Waiter& w, int need) {
+        buckets[need].insert(w);
+        update(0, 0, leaves, need);
+        count++;
+    }
+
+    void erase(const Waiter& w, int need) {
+        map<int, set<Waiter> >::iterator it = buckets.find(need);
+        it->second.erase(w);
+        if (it->second.empty()) buckets.erase(it);
+        update(0, 0, leaves, need);
+        count--;
+    }
+
+    // Earliest waiter (in trace order) needing at most 'limit' KB
+    bool earliest_fitting(int limit, Waiter& w, int& need) const {
+        if (limit < 0) return false;
+        Entry best = earliest(0, 0, leaves, (size_t)limit);
+        if (best.first == NONE) return false;
+        need = best.second;
+        w = *buckets.find(need)->second.begin();
+        return true;
+    }
+
+    int smallest_need() const { return buckets.empty() ? 0 : buckets.begin()->first; }
+
+private:
+    typedef pair<long, int> Entry;  // (earliest trace position, size)
+    static const long NONE = numeric_limits<long>::max();
+
+    struct Node {
+        Entry best;
+        int child[2];  // -1 when the half has no waiters
+
+        Node() : best(NONE, 0) { child[0] = child[1] = -1; }
+    };
+
+    int new_node() {
+        if (free_nodes.empty()) {
+            nodes.push_back(Node());
+            return (int)nodes.size() - 1;
+        }
+        int n = free_nodes.back();
+        free_nodes.pop_back();
+        nodes[n] = Node();
+        return n;
+    }
+
+    // Refresh the path to 'need' below node n, which covers sizes [lo, hi).
+    // Halves left without waiters are released.
+    void update(int n, size_t lo, size_t hi, int need) {
+        if (hi - lo == 1) {
+            map<int, set<Waiter> >::const_iterator it = buckets.find(need);
+            nodes[n].best = it == buckets.end() ? Entry(NONE, 0) : Entry(it->second.begin()->first, need);
+            return;
+        }
+        size_t mid = (lo + hi) / 2;
+        int side = (size_t)need >= mid ? 1 : 0;
+        if (nodes[n].child[side] < 0) {
+            int c = new_node();  // May move 'nodes'
+            nodes[n].child[side] = c;
+        }
+        int c = nodes[n].child[side];
+        update(c, side ? mid : lo, side ? hi : mid, need);
+        if (nodes[c].best.first == NONE) {
+            free_nodes.push_back(c);
+            nodes[n].child[side] = -1;
+        }
+        Entry best(NONE, 0);
+        for (int i = 0; i < 2; ++i) {
+            if (nodes[n].child[i] >= 0) best = min(best, nodes[nodes[n].child[i]].best);
+        }
+        nodes[n].best = best;
+    }
+
+    // Minimum over the sizes [lo, min(hi, limit + 1)) below node n
+    Entry earliest(int n, size_t lo, size_t hi, size_t limit) const {
+        if (n < 0 || lo > limit) return Entry(NONE, 0);
+        if (hi - 1 <= limit) return nodes[n].best;
+        size_t mid = (lo + hi) / 2;
+        return min(earliest(nodes[n].child[0], lo, mid, limit), earliest(nodes[n].child[1], mid, hi, limit));
+    }
+
+    size_t leaves;
+    vector<Node> nodes;      // nodes[0] is the root
+    vector<int> free_nodes;
+    map<int, set<Waiter> > buckets;
+    size_t count;
+} waiting;
+
+// Compaction: slide allocated blocks down when fragmentation keeps a waiting
+// process out of memory although enough memory is free in total.
+bool compaction_enabled = false;
+double compaction_threshold = 0.5;   // Compact when external fragmentation reaches this
+int compaction_fail_limit = 3;       // ...or after this many fragmentation-blocked allocations
+double compaction_cost_per_kb = 0.1; // Time (ms) charged per KB moved
+
+int blocked_allocations = 0;         // Failed allocations that compaction could have fixed
+
+struct CompactionStats {
+    int runs;
+    long kb_moved;
+    long time_spent;
+    int loads_unblocked;   // Processes loaded right after a compaction
+} compaction_stats = {0, 0, 0, 0};
+
+struct SimStats {
+    long processes;        // Valid processes read from the trace
+    long rejected;         // Processes that can never run (bad size or duration)
+    long finished;
+    long total_wait;       // Sum of arrival -> load times
+    long total_turnaround; // Sum of arrival -> finish times
+    long events;
+    int end_time;
+} sim_stats = {0, 0, 0, 0, 0, 0, 0};
+
+Process make_process(int pid, int arrival_time, int duration, int memory_needed) {
+    Process p;
+    p.pid = pid;
+    p.arrival_time = arrival_time;
+    p.duration = duration;
+    p.remaining_time = duration;
+    p.memory_needed = memory_needed;
+    p.in_memory = false;
+    p.load_time = -1;
+    p.finish_time = -1;
+    p.seq = 0;
+    p.arrival_event = 0;
+    return p;
+}
+
+// Supplies processes one at a time in arrival order, so a trace never has to
+// be held in memory as a whole.
+class TraceSource {
+public:
+    virtual ~TraceSource() {}
+    virtual bool next(Process& p) = 0;  // false at the end of the trace
+};
+
+// The original interactive input. The handful of processes typed in are
+// sorted by arrival time before the simulation reads them.
+class PromptSource : public TraceSource {
+public:
+    bool read() {
+        int n = 5; // Number of processes
+        cout << "Enter the number of processes (default is 5): ";
+        cin >> n;
+        if (!cin) {
+            cout << "Invalid input. Using default value of 5.\n";
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            n = 5;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int pid, arrival_time, duration, memory_needed;
+            cout << "Enter PID, Arrival Time, Duration, and Memory Needed for Process " << i + 1 << ": ";
+            cin >> pid >> arrival_time >> duration >> memory_needed;
+
+            if (!cin) {
+                cout << "Invalid input detected. Aborting.\n";
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                return false;
+            }
+
+            entries.push_back(make_process(pid, arrival_time, duration, memory_needed));
+            cout << "Process " << i + 1 << " recorded.\n"; // Debug confirmation
+        }
+
+        stable_sort(entries.begin(), entries.end(), earlier_arrival);
+        pos = 0;
+        return true;
+    }
+
+    bool next(Process& p) {
+        if (pos >= entries.size()) return false;
+        p = entries[pos++];
+        return true;
+    }
 
-void log_state(int current_time, const Process* running_process) {
+private:
+    static bool earlier_arrival(const Process& a, const Process& b) {
+        return a.arrival_time < b.arrival_time;
+    }
+
+    vector<Process> entries;
+    size_t pos;
+};
+
+// CSV trace, one "pid,arrival,duration,memory" record per line. Blank lines,
+// '#' comments and a header line are skipped; malformed lines are reported
+// on stderr and skipped.
+class CsvTraceSource : public TraceSource {
+public:
+    CsvTraceSource(const char* path) : in(path), name(path), line_no(0) {}
+
+    bool is_open() const { return in.is_open(); }
+
+    bool next(Process& p) {
+        string line;
+        while (getline(in, line)) {
+            ++line_no;
+            const char* s = line.c_str();
+            while (*s == ' ' || *s == '\t') ++s;
+            if (*s == '\0' || *s == '#' || *s == '\r') continue;
+            if (line_no == 1 && !isdigit((unsigned char)*s) && *s != '-') continue;  // header
+
+            long fields[4];
+            char* end = (char*)s;
+            int count = 0;
+            for (; count < 4; ++count) {
+                const char* start = end;
+                fields[count] = strtol(start, &end, 10);
+                if (end == start) break;
+                while (*end == ' ' || *end == '\t') ++end;
+                if (count < 3) {
+                    if (*end != ',') break;
+                    ++end;
+                }
+            }
+            while (*end == ' ' || *end == '\t' || *end == '\r') ++end;
+            if (count != 4 || *end != '\0') {
+                cerr << name << ":" << line_no << ": malformed record skipped" << endl;
+                continue;
+            }
+
+            p = make_process(fields[0], fields[1], fields[2], fields[3]);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    ifstream in;
+    string name;
+    long line_no;
+};
+
+// Binary trace: the 4-byte magic "MMTR", a uint32 version, then records of
+// four int32 (pid, arrival, duration, memory) in host byte order.
+const char BINARY_MAGIC[4] = { 'M', 'M', 'T', 'R' };
+const uint32_t BINARY_VERSION = 1;
+
+class BinaryTraceSource : public TraceSource {
+public:
+    BinaryTraceSource(const char* path) : in(path, ios::binary) {}
+
+    bool open() {
+        char magic[4];
+        uint32_t version;
+        if (!in.read(magic, sizeof(magic)) || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) return false;
+        if (!in.read((char*)&version, sizeof(version)) || version != BINARY_VERSION) return false;
+        return true;
+    }
+
+    bool next(Process& p) {
+        int32_t record[4];
+        if (!in.read((char*)record, sizeof(record))) return false;
+        p = make_process(record[0], record[1], record[2], record[3]);
+        return true;
+    }
+
+private:
+    ifstream in;
+};
+
+bool write_binary_trace(TraceSource& source, const char* path) {
+    ofstream out(path, ios::binary);
+    if (!out) return false;
+
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    out.write((const char*)&BINARY_VERSION, sizeof(BINARY_VERSION));
+
+    Process p;
+    while (source.next(p)) {
+        int32_t record[4] = { p.pid, p.arrival_time, p.duration, p.memory_needed };
+        out.write((const char*)record, sizeof(record));
+    }
+    return (bool)out;
+}
+
+void log_state(int current_time) {
     cout << "Time: " << current_time << endl;
 
-    if (running_process) {
-        cout << "CPU: Process " << running_process->pid << " (remaining time: "
-             << running_process->remaining_time << " ms)" << endl;
-    } else {
-        cout << "CPU: Idle" << endl;
+    for (size_t c = 0; c < cores.size(); ++c) {
+        const Core& core = cores[c];
+        cout << "CPU";
+        if (cores.size() > 1) cout << " " << c;
+        if (core.shown_pid >= 0) {
+            cout << ": Process " << core.shown_pid << " (remaining time: "
+                 << core.shown_remaining << " ms)" << endl;
+        } else if (core.running >= 0) {
+            cout << ": Process " << processes[core.running].pid << " (running until "
+                 << core.slice_end << ")" << endl;
+        } else {
+            cout << ": Idle" << endl;
+        }
     }
 
     cout << "Memory State:" << endl;
@@ -50,24 +418,108 @@ void log_state(int current_time, const Process* running_process) {
     cout << "-----------------------------------" << endl;
 }
 
+// Index of the free block the placement policy picks for 'size' KB, or -1
+int find_block(int size) {
+    size_t n = memory.size();
+
+    if (policy == NEXT_FIT) {
+        for (size_t k = 0; k < n; ++k) {
+            size_t i = (next_fit_index + k) % n;
+            if (memory[i].free && memory[i].size >= size) return i;
+        }
+        return -1;
+    }
+
+    int chosen = -1;
+    for (size_t i = 0; i < n; ++i) {
+        const MemoryBlock& block = memory[i];
+        if (!block.free || block.size < size) continue;
+        if (policy == FIRST_FIT) return i;
+        if (chosen < 0
+            || (policy == BEST_FIT && block.size < memory[chosen].size)
+            || (policy == WORST_FIT && block.size > memory[chosen].size)) {
+            chosen = i;
+        }
+    }
+    return chosen;
+}
+
 bool allocate_memory(Process& process) {
+    int i = find_block(process.memory_needed);
+    if (i < 0) return false;
+
+    MemoryBlock& block = memory[i];
+    block.free = false;
+    block.pid = process.pid;
+
+    if (block.size > process.memory_needed) {
+        // Shrink before inserting: emplace may reallocate and invalidate 'block'
+        MemoryBlock rest(block.start + process.memory_needed, block.size - process.memory_needed, true, -1);
+        block.size = process.memory_needed;
+        memory.emplace(memory.begin() + (i + 1), rest);
+    }
+
+    next_fit_index = i + 1;
+    process.in_memory = true;
+    return true;
+}
+
+int total_free_memory() {
+    int total = 0;
     for (size_t i = 0; i < memory.size(); ++i) {
-        MemoryBlock& block = memory[i];
-        if (block.free && block.size >= process.memory_needed) {
-            block.free = false;
-            block.pid = process.pid;
-
-            if (block.size > process.memory_needed) {
-                memory.emplace(memory.begin() + (i + 1),
-                               MemoryBlock(block.start + process.memory_needed, block.size - process.memory_needed, true, -1));
-                block.size = process.memory_needed;
-            }
+        if (memory[i].free) total += memory[i].size;
+    }
+    return total;
+}
 
-            process.in_memory = true;
-            return true;
-        }
+int largest_free_block() {
+    int largest = 0;
+    for (size_t i = 0; i < memory.size(); ++i) {
+        if (memory[i].free && memory[i].size > largest) largest = memory[i].size;
+    }
+    return largest;
+}
+
+// External fragmentation: share of free memory outside the largest hole
+double external_fragmentation() {
+    int total = total_free_memory();
+    return total == 0 ? 0.0 : 1.0 - (double)largest_free_block() / total;
+}
+
+// Move every allocated block to the lowest free address, leaving a single
+// free block at the top. Returns the time charged for the bytes moved.
+int compact_memory() {
+    vector<MemoryBlock> compacted;
+    int next_start = 0;
+    long kb_moved = 0;
+
+    for (size_t i = 0; i < memory.size(); ++i) {
+        const MemoryBlock& block = memory[i];
+        if (block.free) continue;
+        if (block.start != next_start) kb_moved += block.size;
+        compacted.push_back(MemoryBlock(next_start, block.size, false, block.pid));
+        next_start += block.size;
+    }
+    if (next_start < total_memory) {
+        compacted.push_back(MemoryBlock(next_start, total_memory - next_start, true, -1));
     }
-    return false;
+    memory.swap(compacted);
+    next_fit_index = 0;
+
+    int cost = (int)ceil(kb_moved * compaction_cost_per_kb);
+    compaction_stats.runs++;
+    compaction_stats.kb_moved += kb_moved;
+    compaction_stats.time_spent += cost;
+    blocked_allocations = 0;
+    return cost;
+}
+
+bool should_compact() {
+    if (!compaction_enabled || blocked_allocations == 0) return false;
+    double fragmentation = external_fragmentation();
+    if (fragmentation == 0.0) return false;  // Already a single hole, nothing to gain
+    return fragmentation >= compaction_threshold
+        || blocked_allocations >= compaction_fail_limit;
 }
 
 void free_memory(int pid) {
@@ -83,83 +535,572 @@ void free_memory(int pid) {
         if (memory[i].free && memory[i + 1].free) {
             memory[i].size += memory[i + 1].size;
             memory.erase(memory.begin() + i + 1);
+            if (next_fit_index > i + 1) --next_fit_index;
             --i;
         }
     }
 }
 
-void simulate() {
+long now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Call latencies in power-of-two buckets: enough for percentiles over
+// millions of calls without keeping every sample.
+struct LatencyHistogram {
+    long count;
+    long total_ns;
+    long max_ns;
+    long buckets[64];   // buckets[i] counts calls taking [2^i, 2^(i+1)) ns
+
+    void add(long ns) {
+        int b = 0;
+        while (b < 63 && (ns >> (b + 1)) > 0) ++b;
+        buckets[b]++;
+        count++;
+        total_ns += ns;
+        if (ns > max_ns) max_ns = ns;
+    }
+
+    double mean() const { return count ? (double)total_ns / count : 0.0; }
+
+    // Upper bound of the bucket holding the p-th percentile
+    long percentile(double p) const {
+        long target = (long)ceil(p * count), seen = 0;
+        for (int b = 0; b < 64; ++b) {
+            seen += buckets[b];
+            if (seen >= target && seen > 0) return min(max_ns, (2L << b) - 1);
+        }
+        return max_ns;
+    }
+};
+
+// Allocator telemetry: fragmentation and allocation metrics sampled after
+// every scheduling event. Averages are weighted by simulated time; a CSV
+// time series is written every 'interval' events when a file is given.
+class Telemetry {
+public:
+    LatencyHistogram alloc_latency;
+    LatencyHistogram free_latency;
+
+    Telemetry() : interval(1), last_time(0), last_frag(0), last_largest(0), last_blocks(0),
+                  weighted_frag(0), weighted_largest(0), weighted_blocks(0), peak_frag(0),
+                  requests(0), immediate(0), row_requests(0), row_immediate(0),
+                  row_alloc(), row_free() {
+        alloc_latency = free_latency = LatencyHistogram();
+    }
+
+    bool open_csv(const char* path, int every) {
+        csv.open(path);
+        if (!csv) return false;
+        interval = every > 0 ? every : 1;
+        csv << "time,ext_frag,largest_free_kb,free_blocks,free_kb,waiting,alloc_success,alloc_ns,free_ns\n";
+        return true;
+    }
+
+    // An arriving process either got memory right away or had to wait
+    void record_request(bool placed) {
+        requests++;
+        row_requests++;
+        if (placed) {
+            immediate++;
+            row_immediate++;
+        }
+    }
+
+    void record_alloc(long ns) { alloc_latency.add(ns); row_alloc.add(ns); }
+    void record_free(long ns) { free_latency.add(ns); row_free.add(ns); }
+
+    void sample(int current_time, long event, size_t waiting_count) {
+        int free_kb = 0, largest = 0, blocks = 0;
+        for (size_t i = 0; i < memory.size(); ++i) {
+            if (!memory[i].free) continue;
+            free_kb += memory[i].size;
+            largest = max(largest, memory[i].size);
+            blocks++;
+        }
+        double frag = free_kb == 0 ? 0.0 : 1.0 - (double)largest / free_kb;
+
+        int elapsed = current_time - last_time;
+        weighted_frag += last_frag * elapsed;
+        weighted_largest += (double)last_largest * elapsed;
+        weighted_blocks += (double)last_blocks * elapsed;
+        peak_frag = max(peak_frag, frag);
+        last_time = current_time;
+        last_frag = frag;
+        last_largest = largest;
+        last_blocks = blocks;
+
+        if (csv.is_open() && event % interval == 0) {
+            csv << current_time << ',' << fixed << setprecision(4) << frag << ','
+                << largest << ',' << blocks << ',' << free_kb << ',' << waiting_count << ','
+                << (row_requests ? (double)row_immediate / row_requests : 1.0) << ','
+                << setprecision(0) << row_alloc.mean() << ',' << row_free.mean() << '\n';
+            row_requests = row_immediate = 0;
+            row_alloc = row_free = LatencyHistogram();
+        }
+    }
+
+    double avg_fragmentation() const { return last_time ? weighted_frag / last_time : last_frag; }
+    double avg_largest_free() const { return last_time ? weighted_largest / last_time : last_largest; }
+    double avg_free_blocks() const { return last_time ? weighted_blocks / last_time : last_blocks; }
+    double success_rate() const { return requests ? (double)immediate / requests : 1.0; }
+
+    void print_summary() const {
+        cout << fixed << setprecision(3)
+             << "External fragmentation: average " << avg_fragmentation()
+             << ", peak " << peak_frag << endl
+             << setprecision(1)
+             << "Average largest free block: " << avg_largest_free() << " KB"
+             << ", average free blocks: " << avg_free_blocks() << endl
+             << "Allocation success on arrival: " << success_rate() * 100 << "% of " << requests << endl;
+        print_latency("allocate_memory", alloc_latency);
+        print_latency("free_memory", free_latency);
+    }
+
+    void print_json() const {
+        cout << fixed << setprecision(4)
+             << "{\"avg_ext_frag\":" << avg_fragmentation()
+             << ",\"peak_ext_frag\":" << peak_frag
+             << ",\"avg_largest_free_kb\":" << avg_largest_free()
+             << ",\"avg_free_blocks\":" << avg_free_blocks()
+             << ",\"alloc_requests\":" << requests
+             << ",\"alloc_success_rate\":" << success_rate();
+        print_latency_json("alloc_ns", alloc_latency);
+        print_latency_json("free_ns", free_latency);
+        cout << "}";
+    }
+
+private:
+    static void print_latency(const char* name, const LatencyHistogram& h) {
+        cout << setprecision(0) << name << ": " << h.count << " calls, mean " << h.mean()
+             << " ns, p50 " << h.percentile(0.5) << " ns, p99 " << h.percentile(0.99)
+             << " ns, max " << h.max_ns << " ns" << endl;
+    }
+
+    static void print_latency_json(const char* name, const LatencyHistogram& h) {
+        cout << setprecision(1) << ",\"" << name << "\":{\"count\":" << h.count
+             << ",\"mean\":" << h.mean() << ",\"p50\":" << h.percentile(0.5)
+             << ",\"p99\":" << h.percentile(0.99) << ",\"max\":" << h.max_ns << "}";
+    }
+
+    ofstream csv;
+    int interval;
+    int last_time;
+    double last_frag;
+    int last_largest;
+    int last_blocks;
+    double weighted_frag;
+    double weighted_largest;
+    double weighted_blocks;
+    double peak_frag;
+    long requests;
+    long immediate;
+    long row_requests;
+    long row_immediate;
+    LatencyHistogram row_alloc;
+    LatencyHistogram row_free;
+} telemetry;
+
+Core& least_loaded_core() {
+    size_t best = 0;
+    for (size_t c = 1; c < cores.size(); ++c) {
+        if (cores[c].load() < cores[best].load()) best = c;
+    }
+    return cores[best];
+}
+
+// Give an idle CPU with an empty queue the process at the back of the
+// longest queue elsewhere. Returns false if there is nothing to steal.
+bool steal_work(Core& thief) {
+    Core* victim = nullptr;
+    for (size_t c = 0; c < cores.size(); ++c) {
+        if (&cores[c] != &thief && !cores[c].ready_queue.empty()
+            && (!victim || cores[c].ready_queue.size() > victim->ready_queue.size())) {
+            victim = &cores[c];
+        }
+    }
+    if (!victim) return false;
+
+    thief.ready_queue.push_back(victim->ready_queue.back());
+    victim->ready_queue.pop_back();
+    thief.migrations++;
+    return true;
+}
+
+// Load waiting processes into memory in trace order, skipping those that do
+// not fit. Loaded processes join the ready queue. Returns the number loaded;
+// 'fresh' counts the ones that arrived in this event.
+int admit(int current_time, int* fresh = nullptr) {
+    int loaded = 0;
+    int largest = largest_free_block();
+    Waiter w;
+    int need;
+
+    // A waiter that does not fit now cannot fit later in this pass either,
+    // since the largest hole only shrinks as processes are loaded.
+    while (waiting.earliest_fitting(largest, w, need)) {
+        Process& process = processes[w.second];
+        long start = now_ns();
+        allocate_memory(process);  // Cannot fail: a hole of 'largest' KB exists
+        telemetry.record_alloc(now_ns() - start);
+        if (fresh && process.arrival_event == sim_stats.events) (*fresh)++;
+        process.load_time = current_time;
+        least_loaded_core().ready_queue.push_back(w.second);
+        waiting.erase(w, need);
+        largest = largest_free_block();
+        loaded++;
+    }
+
+    if (!waiting.empty() && waiting.smallest_need() <= total_free_memory()) {
+        blocked_allocations++;  // Enough memory in total, but no hole is big enough
+    }
+    return loaded;
+}
+
+// Read trace records until the next one lies in the future. Only processes
+// that are in the system occupy a slot, so memory use does not grow with the
+// length of the trace.
+void read_arrivals(TraceSource& source, int current_time) {
+    Process p;
+    while ((arrivals.empty() || arrivals.top().time <= current_time) && source.next(p)) {
+        if (p.memory_needed <= 0 || p.memory_needed > total_memory || p.duration < 0) {
+            sim_stats.rejected++;
+            continue;
+        }
+
+        p.seq = sim_stats.processes++;
+        int slot;
+        if (free_slots.empty()) {
+            slot = processes.size();
+            processes.push_back(p);
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            processes[slot] = p;
+        }
+
+        Arrival arrival = { p.arrival_time, p.seq, slot };
+        arrivals.push(arrival);
+    }
+}
+
+void finish_process(int slot) {
+    const Process& p = processes[slot];
+    sim_stats.finished++;
+    sim_stats.total_wait += p.load_time - p.arrival_time;
+    sim_stats.total_turnaround += p.finish_time - p.arrival_time;
+    free_slots.push_back(slot);
+}
+
+void print_summary() {
+    cout << "Simulation finished at time " << sim_stats.end_time << endl;
+    if (sim_stats.rejected > 0) {
+        cout << sim_stats.rejected << " process(es) rejected: memory must be 1-"
+             << total_memory << " KB and duration non-negative" << endl;
+    }
+    if (sim_stats.finished > 0) {
+        cout << fixed << setprecision(2)
+             << "Average memory wait: " << (double)sim_stats.total_wait / sim_stats.finished << " ms" << endl
+             << "Average turnaround: " << (double)sim_stats.total_turnaround / sim_stats.finished << " ms" << endl;
+    }
+    if (compaction_enabled) {
+        cout << "Compactions: " << compaction_stats.runs
+             << ", KB moved: " << compaction_stats.kb_moved
+             << ", time charged: " << compaction_stats.time_spent << " ms"
+             << ", processes unblocked: " << compaction_stats.loads_unblocked << endl;
+    }
+    telemetry.print_summary();
+
+    for (size_t c = 0; c < cores.size(); ++c) {
+        const Core& core = cores[c];
+        double span = sim_stats.end_time > 0 ? sim_stats.end_time : 1;
+        cout << setprecision(1) << "CPU " << c << ": busy " << 100 * core.busy_time / span
+             << "%, memory stall " << 100 * core.memory_stall_time / span
+             << "%, idle " << 100 * core.idle_time / span
+             << "%, " << core.slices << " slices, " << core.migrations << " migrations" << endl;
+    }
+}
+
+void print_json() {
+    double finished = sim_stats.finished > 0 ? sim_stats.finished : 1;
+
+    cout << fixed << setprecision(3)
+         << "{\"total_memory\":" << total_memory
+         << ",\"time_quantum\":" << time_quantum
+         << ",\"cpu_count\":" << num_cpus
+         << ",\"work_stealing\":" << (work_stealing ? "true" : "false")
+         << ",\"policy\":\"" << policy_names[policy] << "\""
+         << ",\"processes\":" << sim_stats.processes
+         << ",\"rejected\":" << sim_stats.rejected
+         << ",\"finished\":" << sim_stats.finished
+         << ",\"events\":" << sim_stats.events
+         << ",\"end_time\":" << sim_stats.end_time
+         << ",\"avg_memory_wait\":" << sim_stats.total_wait / finished
+         << ",\"avg_turnaround\":" << sim_stats.total_turnaround / finished
+         << ",\"compaction\":{\"enabled\":" << (compaction_enabled ? "true" : "false")
+         << ",\"runs\":" << compaction_stats.runs
+         << ",\"kb_moved\":" << compaction_stats.kb_moved
+         << ",\"time_charged\":" << compaction_stats.time_spent
+         << ",\"processes_unblocked\":" << compaction_stats.loads_unblocked
+         << "},\"telemetry\":";
+    telemetry.print_json();
+
+    cout << ",\"cpus\":[";
+    for (size_t c = 0; c < cores.size(); ++c) {
+        const Core& core = cores[c];
+        cout << (c ? "," : "") << "{\"busy\":" << core.busy_time
+             << ",\"memory_stall\":" << core.memory_stall_time
+             << ",\"idle\":" << core.idle_time
+             << ",\"slices\":" << core.slices
+             << ",\"migrations\":" << core.migrations << "}";
+    }
+    cout << "]}" << endl;
+}
+
+void simulate(TraceSource& source) {
     int current_time = 0;
-    int finished_processes = 0;
-    size_t total_processes = processes.size();
-
-    while (finished_processes < total_processes) {
-        for (size_t i = 0; i < processes.size(); ++i) {
-            Process& process = processes[i];
-            if (process.arrival_time <= current_time && !process.in_memory) {
-                if (allocate_memory(process)) {
-                    ready_queue.push(i);
-                }
+
+    while (true) {
+        read_arrivals(source, current_time);
+
+        int arrived = 0;
+        while (!arrivals.empty() && arrivals.top().time <= current_time) {
+            const Arrival& arrival = arrivals.top();
+            processes[arrival.slot].arrival_event = sim_stats.events;
+            waiting.insert(Waiter(arrival.seq, arrival.slot), processes[arrival.slot].memory_needed);
+            arrivals.pop();
+            arrived++;
+        }
+        int fresh = 0;
+        admit(current_time, &fresh);
+        for (int i = 0; i < arrived; ++i) telemetry.record_request(i < fresh);
+
+        if (should_compact()) {
+            // Compaction stops every CPU for its duration
+            int cost = compact_memory();
+            for (size_t c = 0; c < cores.size(); ++c) {
+                if (cores[c].running >= 0) cores[c].slice_end += cost;
+                cores[c].memory_stall_time += cost;
             }
+            current_time += cost;
+            compaction_stats.loads_unblocked += admit(current_time);
+            continue;  // Processes may have arrived while memory was being moved
+        }
+
+        // Start a slice on every idle CPU that has (or can steal) work
+        int next_event = arrivals.empty() ? -1 : arrivals.top().time;
+        for (size_t c = 0; c < cores.size(); ++c) {
+            Core& core = cores[c];
+            if (core.running < 0 && core.ready_queue.empty() && !(work_stealing && steal_work(core))) continue;
+            if (core.running < 0) {
+                core.running = core.ready_queue.front();
+                core.ready_queue.pop_front();
+                core.slice_end = current_time + min(time_quantum, processes[core.running].remaining_time);
+                core.slices++;
+            }
+            if (next_event < 0 || core.slice_end < next_event) next_event = core.slice_end;
+        }
+
+        if (next_event < 0) {
+            // No CPU busy and nothing left to arrive: memory is empty, so
+            // nobody is left waiting and the trace is exhausted
+            break;
         }
 
-        Process* running_process = nullptr;
-        if (!ready_queue.empty()) {
-            int process_idx = ready_queue.front();
-            ready_queue.pop();
+        // Charge the time until the next event to each CPU
+        int elapsed = next_event - current_time;
+        if (elapsed < 0) {
+            cerr << "Internal error: next event at " << next_event << " is before time " << current_time << endl;
+            abort();
+        }
+        for (size_t c = 0; c < cores.size(); ++c) {
+            Core& core = cores[c];
+            if (core.running >= 0) core.busy_time += elapsed;
+            else if (!waiting.empty()) core.memory_stall_time += elapsed;
+            else core.idle_time += elapsed;
+            core.shown_pid = -1;
+        }
+        current_time = next_event;  // Jump straight to the next slice end or arrival
 
-            running_process = &processes[process_idx];
-            int execution_time = min(TIME_QUANTUM, running_process->remaining_time);
-            running_process->remaining_time -= execution_time;
-            current_time += execution_time;
+        for (size_t c = 0; c < cores.size(); ++c) {
+            Core& core = cores[c];
+            if (core.running < 0 || core.slice_end != current_time) continue;
 
-            if (running_process->remaining_time == 0) {
-                free_memory(running_process->pid);
-                finished_processes++;
+            int process_idx = core.running;
+            Process& process = processes[process_idx];
+            process.remaining_time -= min(time_quantum, process.remaining_time);
+            core.running = -1;
+            core.shown_pid = process.pid;
+            core.shown_remaining = process.remaining_time;
+
+            if (process.remaining_time == 0) {
+                process.finish_time = current_time;
+                long start = now_ns();
+                free_memory(process.pid);
+                telemetry.record_free(now_ns() - start);
+                finish_process(process_idx);
             } else {
-                ready_queue.push(process_idx);
+                core.ready_queue.push_back(process_idx);
             }
-        } else {
-            current_time++;
         }
 
-        log_state(current_time, running_process);
+        ++sim_stats.events;
+        telemetry.sample(current_time, sim_stats.events, waiting.size());
+        if (log_interval > 0 && sim_stats.events % log_interval == 0) {
+            log_state(current_time);
+        }
     }
+
+    sim_stats.end_time = current_time;
+}
+
+void usage(const char* prog) {
+    cout << "Usage: " << prog << " [options]\n"
+         << "Without a trace the processes are entered interactively.\n"
+         << "  -t, --trace FILE         CSV trace of pid,arrival,duration,memory sorted by arrival\n"
+         << "  -b, --binary FILE        binary trace (see --write-binary)\n"
+         << "  -w, --write-binary FILE  convert the input trace to binary and exit\n"
+         << "  -m, --memory KB          total memory (default 512)\n"
+         << "  -q, --quantum MS         Round Robin time quantum (default 3)\n"
+         << "  -n, --cpus N             number of CPUs, each with its own ready queue (default 1)\n"
+         << "      --no-steal           do not let idle CPUs take work from other queues\n"
+         << "  -p, --policy NAME        placement policy: first, best, worst, next (default first)\n"
+         << "  -l, --log N              log every N-th event, 0 disables (default 1, 0 with a trace)\n"
+         << "  -c, --compact THRESHOLD  enable compaction at this external fragmentation\n"
+         << "      --compact-fails N    also compact after N blocked allocations (default 3)\n"
+         << "      --compact-cost MS    time charged per KB moved (default 0.1)\n"
+         << "  -j, --json               print statistics as JSON\n"
+         << "  -T, --telemetry FILE     write a CSV time series of allocator metrics\n"
+         << "      --telemetry-every N  write a telemetry row every N events (default 1)\n";
 }
 
-int main() {
-    memory.push_back(MemoryBlock(0, TOTAL_MEMORY, true, -1));
+int main(int argc, char** argv) {
+    enum { OPT_COMPACT_FAILS = 256, OPT_COMPACT_COST, OPT_TELEMETRY_EVERY, OPT_NO_STEAL };
+    static const struct option long_options[] = {
+        { "trace", required_argument, 0, 't' },
+        { "binary", required_argument, 0, 'b' },
+        { "write-binary", required_argument, 0, 'w' },
+        { "memory", required_argument, 0, 'm' },
+        { "quantum", required_argument, 0, 'q' },
+        { "cpus", required_argument, 0, 'n' },
+        { "no-steal", no_argument, 0, OPT_NO_STEAL },
+        { "policy", required_argument, 0, 'p' },
+        { "log", required_argument, 0, 'l' },
+        { "compact", required_argument, 0, 'c' },
+        { "compact-fails", required_argument, 0, OPT_COMPACT_FAILS },
+        { "compact-cost", required_argument, 0, OPT_COMPACT_COST },
+        { "json", no_argument, 0, 'j' },
+        { "telemetry", required_argument, 0, 'T' },
+        { "telemetry-every", required_argument, 0, OPT_TELEMETRY_EVERY },
+        { "help", no_argument, 0, 'h' },
+        { 0, 0, 0, 0 }
+    };
 
-    int n = 5; // Number of processes
-    cout << "Enter the number of processes (default is 5): ";
-    cin >> n;
-    if (!cin) {
-        cout << "Invalid input. Using default value of 5.\n";
-        cin.clear();
-        cin.ignore(numeric_limits<streamsize>::max(), '\n');
-        n = 5;
+    const char* csv_path = nullptr;
+    const char* binary_path = nullptr;
+    const char* write_path = nullptr;
+    const char* telemetry_path = nullptr;
+    int telemetry_every = 1;
+    bool json = false;
+    bool log_set = false;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "t:b:w:m:q:n:p:l:c:jT:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 't': csv_path = optarg; break;
+            case 'b': binary_path = optarg; break;
+            case 'w': write_path = optarg; break;
+            case 'm': total_memory = atoi(optarg); break;
+            case 'q': time_quantum = atoi(optarg); break;
+            case 'n': num_cpus = atoi(optarg); break;
+            case OPT_NO_STEAL: work_stealing = false; break;
+            case 'p': {
+                int i = 0;
+                while (i < 4 && strcmp(optarg, policy_names[i]) != 0) ++i;
+                if (i == 4) {
+                    cerr << "Unknown policy '" << optarg << "'" << endl;
+                    return 1;
+                }
+                policy = (Policy)i;
+                break;
+            }
+            case 'l': log_interval = atoi(optarg); log_set = true; break;
+            case 'c': compaction_enabled = true; compaction_threshold = atof(optarg); break;
+            case OPT_COMPACT_FAILS: compaction_fail_limit = atoi(optarg); break;
+            case OPT_COMPACT_COST: compaction_cost_per_kb = atof(optarg); break;
+            case 'j': json = true; break;
+            case 'T': telemetry_path = optarg; break;
+            case OPT_TELEMETRY_EVERY: telemetry_every = atoi(optarg); break;
+            case 'h': usage(argv[0]); return 0;
+            default: usage(argv[0]); return 1;
+        }
     }
 
-    for (int i = 0; i < n; ++i) {
-        Process p;
-        cout << "Enter PID, Arrival Time, Duration, and Memory Needed for Process " << i + 1 << ": ";
-        cin >> p.pid >> p.arrival_time >> p.duration >> p.memory_needed;
+    if (total_memory <= 0 || time_quantum <= 0 || num_cpus <= 0) {
+        cerr << "Memory size, time quantum and CPU count must be positive" << endl;
+        return 1;
+    }
+    if (csv_path && binary_path) {
+        cerr << "Give either --trace or --binary, not both" << endl;
+        return 1;
+    }
 
-        if (!cin) {
-            cout << "Invalid input detected. Aborting.\n";
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    PromptSource prompt_source;
+    CsvTraceSource* csv_source = nullptr;
+    BinaryTraceSource* binary_source = nullptr;
+    TraceSource* source = &prompt_source;
+
+    if (csv_path) {
+        csv_source = new CsvTraceSource(csv_path);
+        if (!csv_source->is_open()) {
+            cerr << "Cannot open trace " << csv_path << endl;
             return 1;
         }
+        source = csv_source;
+    } else if (binary_path) {
+        binary_source = new BinaryTraceSource(binary_path);
+        if (!binary_source->open()) {
+            cerr << "Cannot read binary trace " << binary_path << endl;
+            return 1;
+        }
+        source = binary_source;
+    } else if (!prompt_source.read()) {
+        return 1;
+    }
+
+    if (write_path) {
+        bool ok = write_binary_trace(*source, write_path);
+        if (!ok) cerr << "Cannot write " << write_path << endl;
+        delete csv_source;
+        delete binary_source;
+        return ok ? 0 : 1;
+    }
+
+    if (!log_set && (source != &prompt_source || json)) {
+        log_interval = 0;  // Unattended runs only want the statistics
+    }
 
-        p.remaining_time = p.duration;
-        p.in_memory = false;
-        processes.push_back(p);
-        cout << "Process " << i + 1 << " recorded.\n"; // Debug confirmation
+    if (telemetry_path && !telemetry.open_csv(telemetry_path, telemetry_every)) {
+        cerr << "Cannot write telemetry to " << telemetry_path << endl;
+        return 1;
     }
 
-    cout << "Starting simulation...\n";
-    simulate();
+    memory.push_back(MemoryBlock(0, total_memory, true, -1));
+    waiting.reset(total_memory);
+    cores.resize(num_cpus);
+
+    if (source == &prompt_source) cout << "Starting simulation...\n";
+    simulate(*source);
+
+    if (json) {
+        print_json();
+    } else {
+        print_summary();
+    }
 
+    delete csv_source;
+    delete binary_source;
     return 0;
 }
@@ -5,3 +5,6 @@
 ./scheduler_v0 RR 1000 reverse.txt > rr1000_reverse.txt
 
 
+
+# EDF input lines: name cores deadline_ms runtime_ms
+./scheduler_v2 EDF deadlines.txt 4 > edf_deadlines.txt
@@ -9,6 +9,11 @@
 #include <unistd.h>
 #include <pthread.h>
 #include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 
 
 #define MAX_LINE_LENGTH 80
@@ -16,6 +21,7 @@
 
 void fcfs();
 void rr();
+void edf();
 
 #define PROC_NEW    0
 #define PROC_STOPPED 1
@@ -34,7 +40,12 @@ typedef struct proc_desc {
     char name[80];
     int pid;
     int status;
+    int id;                     // Index in all_processes, the job's name in the journal
     int reqCores;
+    int adopted;                // Running since before a restart: not our child
+    unsigned long long start_ticks;  // Start time from /proc/<pid>/stat
+    double deadline, runtime;   // EDF: relative deadline and expected runtime (secs), 0 if none
+    double t_deadline;          // EDF: absolute deadline
     double t_submission, t_start, t_end;
 } proc_t;
 
@@ -57,6 +68,7 @@ proc_t *all_processes[MAX_PROCESSES];  // Global array to hold pointers to all p
 
 void add_to_all_processes(proc_t *proc) {
     if (process_count < MAX_PROCESSES) {
+        proc->id = process_count;
         all_processes[process_count++] = proc;
     } else {
         printf("Error: Maximum number of processes exceeded.\n");
@@ -118,21 +130,306 @@ double proc_gettime() {
 
 #define FCFS 0
 #define RR   1
+#define EDF  2
 
 int policy = FCFS;
 int quantum = 100; /* ms */
 proc_t *running_proc;
 double global_t;
 
+// Tell the job how many cores it was given, so the load generator (work)
+// starts one thread per core, and how long it is expected to run (EDF).
+// Called in the child before execl
+void export_cores(proc_t *proc) {
+    char value[32];
+    snprintf(value, sizeof(value), "%d", proc->reqCores);
+    setenv("WORK_THREADS", value, 1);
+    if (proc->runtime > 0) {
+        snprintf(value, sizeof(value), "%.0f", proc->runtime * 1000);
+        setenv("WORK_MS", value, 1);
+    }
+}
+
 void err_exit(char *msg) {
     printf("Error: %s\n", msg);
     exit(1);
 }
 
+/*
+ * Crash-safe journal (FCFS and EDF). One text record per event, appended:
+ *   S <id> <t_submission> <cores> <deadline> <runtime> <name>
+ *   W <global_t> <policy> <input>                      workload start
+ *   D <id> <pid> <start_ticks> <t_start>               dispatched
+ *   X <id>                                             exited (or rejected)
+ * Records are buffered and reach the disk with one fdatasync per scheduling
+ * round, just before the scheduler blocks, so a dispatch only costs a
+ * buffered write. The W record follows the last S, so a journal without
+ * one was cut short while the input was read, before anything ran.
+ * The scheduler holds an exclusive flock on the journal while it runs and a
+ * clean finish removes it; a journal found unlocked at start means the last
+ * run died, and if it was the same policy and input its state is replayed
+ * instead of the input.
+ */
+FILE *journal = NULL;
+int journal_dirty = 0;
+
+const char *journal_path() {
+    const char *path = getenv("SCHED_JOURNAL");
+    return path ? path : "scheduler_v2.journal";
+}
+
+void journal_commit() {
+    if (!journal || !journal_dirty) return;
+    if (fflush(journal) != 0 || fdatasync(fileno(journal)) == -1) {
+        perror("[ERROR] journal write failed");
+        exit(EXIT_FAILURE);
+    }
+    journal_dirty = 0;
+}
+
+void journal_submit(proc_t *proc) {
+    if (!journal) return;
+    fprintf(journal, "S %d %.6f %d %.6f %.6f %s\n", proc->id, proc->t_submission, proc->reqCores,
+            proc->deadline, proc->runtime, proc->name);
+    journal_dirty = 1;
+}
+
+// Start time of a process in clock ticks since boot (field 22 of
+// /proc/<pid>/stat), 0 if it is gone or a zombie. Tells a job apart from an
+// unrelated process that got its pid after it exited
+unsigned long long proc_start_ticks(int pid) {
+    char path[64], buf[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *stat = fopen(path, "r");
+    if (!stat) return 0;
+    size_t length = fread(buf, 1, sizeof(buf) - 1, stat);
+    fclose(stat);
+    buf[length] = '\0';
+
+    // The command name may hold spaces: fields are counted after its ')'
+    char *p = strrchr(buf, ')');
+    char state;
+    unsigned long long ticks;
+    if (!p || sscanf(p + 2, "%c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu",
+                     &state, &ticks) != 2) {
+        return 0;
+    }
+    return state == 'Z' || state == 'X' ? 0 : ticks;
+}
+
+void journal_dispatch(proc_t *proc) {
+    proc->start_ticks = proc_start_ticks(proc->pid);
+    if (!journal) return;
+    fprintf(journal, "D %d %d %llu %.6f\n", proc->id, proc->pid, proc->start_ticks, proc->t_start);
+    journal_dirty = 1;
+}
+
+void journal_exit(proc_t *proc) {
+    if (!journal) return;
+    fprintf(journal, "X %d\n", proc->id);
+    journal_dirty = 1;
+}
+
+// Whether an adopted job still runs: same pid and the same start time
+int adopted_alive(proc_t *proc) {
+    if (kill(proc->pid, 0) == -1 && errno == ESRCH) return 0;
+    return proc_start_ticks(proc->pid) == proc->start_ticks;
+}
+
+// waitpid for the running jobs. Adopted jobs belong to init after a restart,
+// so while any run they are polled alongside a non-blocking waitpid
+int wait_for_exit(int *status) {
+    journal_commit();
+    while (1) {
+        int adopted = 0;
+        for (proc_t *proc = running_q.first; proc != NULL; proc = proc->next) {
+            if (!proc->adopted) continue;
+            if (!adopted_alive(proc)) {
+                *status = 0;
+                return proc->pid;
+            }
+            adopted++;
+        }
+        if (adopted == 0) return waitpid(-1, status, 0);
+
+        int pid = waitpid(-1, status, WNOHANG);
+        if (pid != 0 && !(pid == -1 && errno == ECHILD)) return pid;
+
+        struct timespec poll = { 0, 20 * 1000000L };
+        nanosleep(&poll, NULL);
+    }
+}
+
+proc_t *new_proc(const char *name) {
+    proc_t *proc = calloc(1, sizeof(proc_t));
+    if (!proc) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    strncpy(proc->name, name, sizeof(proc->name) - 1);
+    proc->pid = -1;
+    proc->status = PROC_NEW;
+    proc->reqCores = 1;
+    return proc;
+}
+
+// Rebuild the queues from the journal of a run that died: submitted jobs go
+// back to global_q, dispatched ones still running are re-adopted by pid
+int journal_recover(const char *path) {
+    char line[PATH_MAX + 64], name[80];
+    int id, pid, cores;
+    unsigned long long ticks;
+    double t, deadline, runtime;
+    int recovered = 0;
+
+    FILE *in = fopen(path, "r");
+    if (!in) return 0;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        // A record cut short by the crash does not parse and is dropped
+        if (line[0] == 'W' && sscanf(line, "W %lf", &t) == 1) {
+            global_t = t;
+        } else if (line[0] == 'S' && sscanf(line, "S %d %lf %d %lf %lf %79s", &id, &t, &cores, &deadline, &runtime, name) == 6) {
+            if (id != process_count) continue;
+            proc_t *proc = new_proc(name);
+            proc->t_submission = t;
+            proc->reqCores = cores;
+            proc->deadline = deadline;
+            proc->runtime = runtime;
+            add_to_all_processes(proc);
+        } else if (line[0] == 'D' && sscanf(line, "D %d %d %llu %lf", &id, &pid, &ticks, &t) == 4) {
+            if (id < 0 || id >= process_count) continue;
+            all_processes[id]->pid = pid;
+            all_processes[id]->start_ticks = ticks;
+            all_processes[id]->t_start = t;
+            all_processes[id]->status = PROC_RUNNING;
+        } else if (line[0] == 'X' && sscanf(line, "X %d", &id) == 1) {
+            if (id < 0 || id >= process_count) continue;
+            all_processes[id]->status = PROC_EXITED;
+        }
+    }
+    fclose(in);
+
+    for (int i = 0; i < process_count; i++) {
+        proc_t *proc = all_processes[i];
+        if (proc->status == PROC_NEW) {
+            proc_to_rq_end(proc, &global_q);
+            remprocs++;
+            recovered++;
+        } else if (proc->status == PROC_RUNNING && adopted_alive(proc)) {
+            printf("Re-adopted PID %d - CMD: %s\n", proc->pid, proc->name);
+            proc->adopted = 1;
+            proc->t_deadline = proc->deadline > 0 ? proc->t_submission + proc->deadline : HUGE_VAL;
+            proc_to_rq_end(proc, &running_q);
+            active_procs++;
+            recovered++;
+        } else if (proc->status == PROC_RUNNING) {
+            printf("PID %d - CMD: %s ended while the scheduler was down\n", proc->pid, proc->name);
+            proc->status = PROC_EXITED;
+            journal_exit(proc);
+        }
+    }
+    return recovered;
+}
+
+// The workload a journal was written for, from its W record. Returns 0 if
+// it has none: the run died while reading its input
+int journal_workload(const char *path, char *policy_name, size_t policy_size, char *input_path, size_t input_size) {
+    char line[PATH_MAX + 64];
+    int found = 0, offset;
+    double t;
+
+    FILE *in = fopen(path, "r");
+    if (!in) return 0;
+    while (!found && fgets(line, sizeof(line), in) != NULL) {
+        char name[16];
+        offset = 0;
+        if (line[0] != 'W' || sscanf(line, "W %lf %15s %n", &t, name, &offset) != 2 || offset == 0) continue;
+        line[strcspn(line, "\n")] = '\0';
+        snprintf(policy_name, policy_size, "%s", name);
+        snprintf(input_path, input_size, "%s", line + offset);
+        found = 1;
+    }
+    fclose(in);
+    return found;
+}
+
+// Lock the journal for this run; another scheduler holding it is an error
+int journal_lock(const char *path) {
+    while (1) {
+        int fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);  // Jobs must not hold the lock
+        if (fd == -1) {
+            perror("[ERROR] cannot open journal");
+            exit(EXIT_FAILURE);
+        }
+        if (flock(fd, LOCK_EX | LOCK_NB) == -1) {
+            if (errno == EWOULDBLOCK) {
+                printf("Error: another scheduler is running with journal %s\n", path);
+                exit(1);
+            }
+            perror("[ERROR] cannot lock journal");
+            exit(EXIT_FAILURE);
+        }
+
+        // A scheduler that just finished removes its journal before it lets go
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_nlink > 0) return fd;
+        close(fd);
+    }
+}
+
+// Open and lock the journal of this policy and input: replay it if a run of
+// the same workload left one behind, else start a fresh one. Returns 1 when
+// the state came from the journal
+int journal_open(const char *policy_name, const char *input_path) {
+    const char *path = journal_path();
+    char recorded_policy[16], recorded_input[PATH_MAX];
+    struct stat st;
+
+    int fd = journal_lock(path);
+    int recovering = 0;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        if (!journal_workload(path, recorded_policy, sizeof(recorded_policy), recorded_input, sizeof(recorded_input))) {
+            printf("Discarding %s: the last run stopped while reading its input\n", path);
+        } else if (strcmp(recorded_policy, policy_name) != 0 || strcmp(recorded_input, input_path) != 0) {
+            printf("Error: %s holds an unfinished %s run of %s; run that again to recover it, "
+                   "or remove the journal\n", path, recorded_policy, recorded_input);
+            exit(1);
+        } else {
+            recovering = 1;
+        }
+    }
+    if (!recovering && ftruncate(fd, 0) == -1) {
+        perror("[ERROR] cannot reset journal");
+        exit(EXIT_FAILURE);
+    }
+
+    journal = fdopen(fd, "a");
+    if (!journal) {
+        perror("[ERROR] cannot open journal");
+        exit(EXIT_FAILURE);
+    }
+    setvbuf(journal, NULL, _IOFBF, 1 << 16);
+    if (recovering) {
+        printf("Recovering from %s\n", path);
+        printf("%d jobs to carry on\n", journal_recover(path));
+    }
+    return recovering;
+}
+
+// The workload is done: nothing is left to recover
+void journal_close() {
+    if (!journal) return;
+    unlink(journal_path());  // Still locked, so no other run can take it for a crash
+    fclose(journal);
+    journal = NULL;
+}
+
 int main(int argc, char **argv) {
     FILE *input;
+    const char *input_name;
+    char input_path[PATH_MAX];
+    char line[MAX_LINE_LENGTH];
     char exec[80];
-    int c;
     proc_t *proc;
 
     if (argc < 2) {
@@ -141,45 +438,69 @@ int main(int argc, char **argv) {
 
     if (!strcmp(argv[1], "FCFS")) {
         policy = FCFS;
+        input_name = argv[2];
         input = fopen(argv[2], "r");
         if (argc > 3) numOfCpus = atoi(argv[3]);
         if (input == NULL) err_exit("invalid input file name");
     } else if (!strcmp(argv[1], "RR")) {
         policy = RR;
         quantum = atoi(argv[2]);
+        input_name = argv[3];
         input = fopen(argv[3], "r");
         if (argc > 4) numOfCpus = atoi(argv[4]);
         if (input == NULL) err_exit("invalid input file name");
+    } else if (!strcmp(argv[1], "EDF")) {
+        policy = EDF;
+        input_name = argv[2];
+        input = fopen(argv[2], "r");
+        if (argc > 3) numOfCpus = atoi(argv[3]);
+        if (input == NULL) err_exit("invalid input file name");
     } else {
         err_exit("invalid usage");
     }
 
-    /* Read input file */
-    while ((c = fscanf(input, "%s", exec)) != EOF) {
-        proc = malloc(sizeof(proc_t));
-        if (!proc) {
-            perror("malloc");
-            exit(EXIT_FAILURE);
-        }
-        proc->next = NULL;
-        strcpy(proc->name, exec);
-        proc->pid = -1;
-        proc->status = PROC_NEW;
-        proc->t_submission = proc_gettime();
+    proc_queue_init(&running_q);
+
+    // The journal names the input by its full path, wherever the run starts
+    if (!realpath(input_name, input_path)) snprintf(input_path, sizeof(input_path), "%s", input_name);
+
+    // RR keeps its stop/continue state in its threads and is not journaled
+    if (policy != RR && journal_open(argv[1], input_path)) {
+        fclose(input);
+        input = NULL;
+    }
 
+    /* Read input file: one job per line, "name [cores [deadline_ms runtime_ms]]" */
+    while (input && fgets(line, sizeof(line), input) != NULL) {
         int numCores;
-        if (fscanf(input, "%d", &numCores) == 1) {
-            proc->reqCores = numCores;
+        double deadline, runtime;
+        int fields = sscanf(line, "%79s %d %lf %lf", exec, &numCores, &deadline, &runtime);
+        if (fields < 1) continue;
+
+        proc = new_proc(exec);
+        proc->t_submission = proc_gettime();
+        proc->reqCores = fields >= 2 ? numCores : 1;
+        if (fields >= 4 && deadline > 0 && runtime > 0) {
+            proc->deadline = deadline / 1000;
+            proc->runtime = runtime / 1000;
         } else {
-            proc->reqCores = 1;
+            proc->deadline = proc->runtime = 0;
         }
 
         proc_to_rq_end(proc, &global_q);
         add_to_all_processes(proc);
+        journal_submit(proc);
         remprocs++;
     }
 
-    global_t = proc_gettime();
+    if (input) {
+        global_t = proc_gettime();
+        if (journal) {
+            fprintf(journal, "W %.6f %s %s\n", global_t, argv[1], input_path);
+            journal_dirty = 1;
+        }
+        journal_commit();
+    }
     switch (policy) {
         case FCFS:
             fcfs();
@@ -189,20 +510,33 @@ int main(int argc, char **argv) {
             rr();
             break;
 
+        case EDF:
+            edf();
+            break;
+
         default:
             err_exit("Unimplemented policy");
             break;
     }
 
+    journal_close();
     printf("WORKLOAD TIME: %.2lf secs\n", proc_gettime() - global_t);
     printf("scheduler exits\n");
     return 0;
 }
 
+// Cores left over by the jobs already running (re-adopted after a restart)
+int free_cpus() {
+    int available = numOfCpus;
+    for (proc_t *proc = running_q.first; proc != NULL; proc = proc->next) {
+        available -= proc->reqCores;
+    }
+    return available;
+}
+
 void fcfs() {
     int status;
-    int available_cpus = numOfCpus;
-    proc_queue_init(&running_q);
+    int available_cpus = free_cpus();
 
     while (active_procs > 0 || !proc_queue_empty(&global_q)) {
         //printf("[DEBUG] Starting scheduling iteration...\n");
@@ -239,6 +573,7 @@ void fcfs() {
                 }
                 if (pid == 0) {
                     //printf("[DEBUG] Executing process %s\n", current_proc->name);
+                    export_cores(current_proc);
                     execl(current_proc->name, current_proc->name, NULL);
                     perror("[ERROR] execl failed");
                     _exit(EXIT_FAILURE);
@@ -248,6 +583,7 @@ void fcfs() {
                     active_procs++;
                     available_cpus -= current_proc->reqCores; // Update available CPUs
                     proc_to_rq_end(current_proc, &running_q); // Add to running queue
+                    journal_dispatch(current_proc);
                     //printf("[DEBUG] Process %d begins, requested %d CPUs\n", pid, current_proc->reqCores);
                 }
 
@@ -260,7 +596,7 @@ void fcfs() {
         }
 
         // Wait for any process to finish
-        int finished_pid = waitpid(-1, &status, 0);
+        int finished_pid = wait_for_exit(&status);
         if (finished_pid > 0) {
             //printf("[DEBUG] Process %d finished execution\n", finished_pid);
             active_procs--;
@@ -290,6 +626,7 @@ void fcfs() {
                     }
 
                     // Free the finished process
+                    journal_exit(finished_proc);
                     free(finished_proc);
 
                     break; // Exit the loop after removing the finished process
@@ -389,6 +726,7 @@ void *rr_thread_func(void *args) {
             }
             if (pid == 0) {
                 printf("executing %s\n", proc->name);
+                export_cores(proc);
                 execl(proc->name, proc->name, NULL);
             } else {
                 proc->pid = pid;
@@ -449,4 +787,161 @@ void rr() {
     }
 
     pthread_mutex_destroy(&queue_mutex); // Destroy mutex
-}
\ No newline at end of file
+}
+
+
+
+// EDF: the ready set is a min-heap on the absolute deadline
+proc_t *ready_heap[MAX_PROCESSES];
+int ready_count = 0;
+
+void heap_push(proc_t *proc) {
+    int i = ready_count++;
+    while (i > 0 && ready_heap[(i - 1) / 2]->t_deadline > proc->t_deadline) {
+        ready_heap[i] = ready_heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    ready_heap[i] = proc;
+}
+
+proc_t *heap_pop() {
+    proc_t *top = ready_heap[0];
+    proc_t *last = ready_heap[--ready_count];
+    int i = 0;
+
+    while (2 * i + 1 < ready_count) {
+        int child = 2 * i + 1;
+        if (child + 1 < ready_count && ready_heap[child + 1]->t_deadline < ready_heap[child]->t_deadline) child++;
+        if (last->t_deadline <= ready_heap[child]->t_deadline) break;
+        ready_heap[i] = ready_heap[child];
+        i = child;
+    }
+    ready_heap[i] = last;
+    return top;
+}
+
+// Utilization-based admission: a job with a deadline uses
+// runtime * cores / deadline of the machine, and the admitted jobs together
+// may not use more than numOfCpus. Jobs without a deadline always run, after
+// every job that has one
+int edf_admit(proc_t *proc, double *utilization) {
+    if (proc->reqCores > numOfCpus) return 0;
+    if (proc->deadline == 0) {
+        proc->t_deadline = HUGE_VAL;
+        return 1;
+    }
+
+    // A job runs on one CPU per core at best, so its runtime must fit its deadline
+    if (proc->runtime > proc->deadline) return 0;
+
+    double u = proc->runtime * proc->reqCores / proc->deadline;
+    if (*utilization + u > numOfCpus) return 0;
+    *utilization += u;
+    proc->t_deadline = proc->t_submission + proc->deadline;
+    return 1;
+}
+
+void edf() {
+    int status;
+    int available_cpus = free_cpus();
+    double utilization = 0;
+    int admitted = 0, rejected = 0, timed = 0, missed = 0;
+    double lateness_sum = 0, max_lateness = -HUGE_VAL;
+    proc_t *proc;
+
+    // Jobs re-adopted after a restart were admitted by the previous run
+    for (proc = running_q.first; proc != NULL; proc = proc->next) {
+        if (proc->deadline > 0) utilization += proc->runtime * proc->reqCores / proc->deadline;
+    }
+
+    while ((proc = proc_rq_dequeue()) != NULL) {
+        if (edf_admit(proc, &utilization)) {
+            heap_push(proc);
+            admitted++;
+        } else if (proc->runtime > proc->deadline) {
+            printf("REJECTED %s: %.0f ms of work cannot finish within its %.0f ms deadline\n",
+                   proc->name, proc->runtime * 1000, proc->deadline * 1000);
+            journal_exit(proc);
+            rejected++;
+        } else {
+            printf("REJECTED %s: %d cores, %.0f ms in %.0f ms does not fit (utilization %.2f of %d)\n",
+                   proc->name, proc->reqCores, proc->runtime * 1000, proc->deadline * 1000, utilization, numOfCpus);
+            journal_exit(proc);
+            rejected++;
+        }
+    }
+
+    while (active_procs > 0 || ready_count > 0) {
+        // Earliest deadline first; a job that does not fit yet holds back the
+        // later ones rather than be overtaken
+        while (ready_count > 0 && ready_heap[0]->reqCores <= available_cpus) {
+            proc = heap_pop();
+            proc->t_start = proc_gettime();
+            int pid = fork();
+            if (pid == -1) {
+                perror("[ERROR] Fork failed");
+                exit(EXIT_FAILURE);
+            }
+            if (pid == 0) {
+                export_cores(proc);
+                execl(proc->name, proc->name, NULL);
+                perror("[ERROR] execl failed");
+                _exit(EXIT_FAILURE);
+            }
+            proc->pid = pid;
+            proc->status = PROC_RUNNING;
+            active_procs++;
+            available_cpus -= proc->reqCores;
+            proc_to_rq_end(proc, &running_q);
+            journal_dispatch(proc);
+        }
+
+        int finished_pid = wait_for_exit(&status);
+        if (finished_pid < 0) {
+            if (errno == EINTR) continue;
+            perror("[ERROR] waitpid failed");
+            exit(EXIT_FAILURE);
+        }
+
+        proc_t *prev = NULL;
+        for (proc = running_q.first; proc != NULL; prev = proc, proc = proc->next) {
+            if (proc->pid == finished_pid) break;
+        }
+        if (proc == NULL) continue;
+        if (prev) {
+            prev->next = proc->next;
+        } else {
+            running_q.first = proc->next;
+        }
+        if (proc->next == NULL) {
+            running_q.last = prev;
+        }
+        running_q.members--;
+
+        active_procs--;
+        available_cpus += proc->reqCores;
+        proc->status = PROC_EXITED;
+        proc->t_end = proc_gettime();
+
+        printf("PID %d - CMD: %s\n", finished_pid, proc->name);
+        printf("\tElapsed time = %.2lf secs\n", proc->t_end - proc->t_submission);
+        printf("\tExecution time = %.2lf secs\n", proc->t_end - proc->t_start);
+        printf("\tWorkload time = %.2lf secs\n", proc->t_end - global_t);
+        if (proc->deadline > 0) {
+            double lateness = proc->t_end - proc->t_deadline;
+            printf("\tLateness = %+.2lf secs%s\n", lateness, lateness > 0 ? " (deadline missed)" : "");
+            timed++;
+            lateness_sum += lateness;
+            if (lateness > max_lateness) max_lateness = lateness;
+            if (lateness > 0) missed++;
+        }
+        journal_exit(proc);
+        free(proc);
+    }
+
+    printf("EDF: %d admitted, %d rejected, utilization %.2f of %d cpus\n", admitted, rejected, utilization, numOfCpus);
+    if (timed > 0) {
+        printf("EDF: deadline miss ratio %.2f%% (%d of %d), mean lateness %+.2lf secs, max lateness %+.2lf secs\n",
+               100.0 * missed / timed, missed, timed, lateness_sum / timed, max_lateness);
+    }
+}
@@ -1,39 +1,373 @@
+/*
+ * Load generator for the scheduler experiments.
+ *
+ *   work [-p profile] [-t ms] [-n threads]
+ *   workN                     (a link to work: N seconds of the default profile)
+ *
+ * Profiles:
+ *   cpu     floating point in registers
+ *   mem     streaming copies between two large buffers (memory bandwidth)
+ *   cache   random pointer chasing over a buffer far larger than the caches
+ *   io      64 KiB writes to a scratch file, synced every 16 writes
+ *   bursty  10 ms of cpu work, then as long asleep: half of the time is sleep
+ *
+ * The duration is an amount of work, not a deadline: the generator times its
+ * own kernel for a few milliseconds, converts the request into a number of
+ * steps and then runs exactly those, so a job that is stopped or shares a
+ * core takes longer, as a real one would. Every thread runs the full amount.
+ * A bursty job's amount is half the duration, and it sleeps the other half.
+ *
+ * Options not given come from WORK_PROFILE, WORK_MS and WORK_THREADS; the
+ * scheduler sets WORK_THREADS to the cores the job asked for.
+ */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <math.h>
 #include <unistd.h>
-#include <stdlib.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+
+#define UNIT_MS		1000		/* workN runs N units */
+#define CALIBRATE_MS	10		/* per round */
+#define CALIBRATE_ROUNDS	5
+#define WARMUP_MS	50
+#define BUFFER_SIZE	(64 << 20)	/* mem, per thread */
+#define CYCLE_SIZE	(32 << 20)	/* cache, per thread: well past the last level cache */
+#define MEM_STEP	(1 << 20)
+#define CACHE_STEP	4096
+#define CPU_STEP	1000
+#define IO_BLOCK	(64 << 10)
+#define IO_SYNC_EVERY	16
+#define BURST_MS	10
+
+enum { CPU, MEM, CACHE, IO, BURSTY };
+
+static const char *profile_names[] = { "cpu", "mem", "cache", "io", "bursty" };
+
+struct worker {
+	pthread_t thread;
+	int profile;
+	long steps;
+	char *buffer;		/* mem: two halves; cache: the chase cycle */
+	size_t position;
+	int fd;
+	long writes;
+	double sink;
+	double rest_ms;		/* bursty: sleep owed for the calibration's work */
+};
+
+static double steps_per_ms;	/* Filled in by calibrate() */
+
+static double now_ms(clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void sleep_ms(double ms)
+{
+	struct timespec pause = { (time_t)(ms / 1000), (long)(fmod(ms, 1000) * 1e6) };
+
+	nanosleep(&pause, NULL);
+}
+
+static void cpu_step(struct worker *w)
+{
+	double a = w->sink;
+	int i;
+
+	for (i = 0; i < CPU_STEP; i++)
+		a = sqrt(a * 1.000001 + 1.1) + 0.5;
+	w->sink = a;
+}
+
+static void mem_step(struct worker *w)
+{
+	size_t half = BUFFER_SIZE / 2;
+
+	memcpy(w->buffer + half + w->position, w->buffer + w->position, MEM_STEP);
+	w->position = (w->position + MEM_STEP) % half;
+}
+
+static void cache_step(struct worker *w)
+{
+	size_t *cycle = (size_t *)w->buffer;
+	size_t at = w->position;
+	int i;
+
+	for (i = 0; i < CACHE_STEP; i++)
+		at = cycle[at];
+	w->position = at;
+}
+
+static void io_step(struct worker *w)
+{
+	if (write(w->fd, w->buffer, IO_BLOCK) != IO_BLOCK) {
+		perror("write");
+		exit(EXIT_FAILURE);
+	}
+	if (++w->writes % IO_SYNC_EVERY == 0) {
+		fdatasync(w->fd);
+		lseek(w->fd, 0, SEEK_SET);
+	}
+}
+
+static void step(struct worker *w)
+{
+	switch (w->profile) {
+	case MEM:
+		mem_step(w);
+		break;
+	case CACHE:
+		cache_step(w);
+		break;
+	case IO:
+		io_step(w);
+		break;
+	default:
+		cpu_step(w);
+		break;
+	}
+}
+
+static void worker_init(struct worker *w, int profile, uint64_t seed)
+{
+	size_t i, n;
+	size_t *cycle;
+
+	memset(w, 0, sizeof(*w));
+	w->profile = profile;
+	w->fd = -1;
+
+	switch (profile) {
+	case MEM:
+		w->buffer = malloc(BUFFER_SIZE);
+		if (!w->buffer) {
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
+		memset(w->buffer, 1, BUFFER_SIZE);
+		break;
+	case CACHE:
+		w->buffer = malloc(CYCLE_SIZE);
+		if (!w->buffer) {
+			perror("malloc");
+			exit(EXIT_FAILURE);
+		}
 
-double a = 1.1;
+		/* One random cycle through every slot (Sattolo), so no hop is predictable */
+		cycle = (size_t *)w->buffer;
+		n = CYCLE_SIZE / sizeof(size_t);
+		for (i = 0; i < n; i++)
+			cycle[i] = i;
+		for (i = n - 1; i > 0; i--) {
+			size_t j;
+			size_t t = cycle[i];
 
-void core_delay()
+			seed ^= seed << 13;	/* xorshift: rand() would dominate the setup */
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			j = seed % i;
+
+			cycle[i] = cycle[j];
+			cycle[j] = t;
+		}
+		break;
+	case IO: {
+		char path[] = "/tmp/workXXXXXX";
+
+		w->fd = mkstemp(path);
+		if (w->fd == -1) {
+			perror("mkstemp");
+			exit(EXIT_FAILURE);
+		}
+		unlink(path);
+		w->buffer = calloc(1, IO_BLOCK);
+		if (!w->buffer) {
+			perror("calloc");
+			exit(EXIT_FAILURE);
+		}
+		break;
+	}
+	}
+}
+
+/*
+ * Steps per millisecond of this profile on this machine: the median of a few
+ * short windows, since one window can land on a noisy moment, after a warm-up
+ * that is not timed (the first passes over a fresh buffer are slower while
+ * page tables and TLBs fill). I/O waits, so it is timed on the wall clock; the
+ * others on the thread's CPU clock. The windows shrink to fit a job shorter
+ * than all of them. Returns the steps it ran, which count towards the job
+ */
+static long calibrate(struct worker *w, long ms)
 {
-	unsigned long j;
+	clockid_t clock = w->profile == IO ? CLOCK_MONOTONIC : CLOCK_THREAD_CPUTIME_ID;
+	double full = WARMUP_MS + CALIBRATE_ROUNDS * CALIBRATE_MS;
+	double scale = ms < full ? ms / full : 1;
+	double rates[CALIBRATE_ROUNDS], t;
+	long total = 0;
+	int i, j;
+
+	for (i = -1; i < CALIBRATE_ROUNDS; i++) {
+		double start = now_ms(clock), elapsed;
+		long steps = 0;
+
+		do {
+			step(w);
+			steps++;
+			elapsed = now_ms(clock) - start;
+		} while (elapsed < (i < 0 ? WARMUP_MS : CALIBRATE_MS) * scale);
 
-	for (j = 0; j < 100000; j++) {
-		a += sqrt(1.1)*sqrt(1.2)*sqrt(1.3)*sqrt(1.4)*sqrt(1.5);
-		a += sqrt(1.6)*sqrt(1.7)*sqrt(1.8)*sqrt(1.9)*sqrt(2.0);
-		a += sqrt(1.1)*sqrt(1.2)*sqrt(1.3)*sqrt(1.4)*sqrt(1.5);
-		a += sqrt(1.6)*sqrt(1.7)*sqrt(1.8)*sqrt(1.9);
+		total += steps;
+		if (i < 0)
+			continue;
+		rates[i] = steps / elapsed;
+		for (j = i; j > 0 && rates[j - 1] > rates[j]; j--) {
+			t = rates[j];
+			rates[j] = rates[j - 1];
+			rates[j - 1] = t;
+		}
 	}
+
+	steps_per_ms = rates[CALIBRATE_ROUNDS / 2];
+	return total;
 }
 
-void delay(int workload)
+static void *run(void *arg)
+{
+	struct worker *w = arg;
+	long done = 0;
+	double begin, slept;
+
+	if (w->profile != BURSTY) {
+		for (; done < w->steps; done++)
+			step(w);
+		return NULL;
+	}
+
+	/*
+	 * Each pause brings the time asleep up to the cpu time used, so bursts
+	 * that run long and sleeps that wake late even out over the job
+	 */
+	begin = now_ms(CLOCK_THREAD_CPUTIME_ID);
+	slept = -w->rest_ms;
+
+	do {
+		long burst = (long)(steps_per_ms * BURST_MS) + 1;
+		double owed, start;
+
+		for (; burst > 0 && done < w->steps; burst--, done++)
+			cpu_step(w);
+		owed = now_ms(CLOCK_THREAD_CPUTIME_ID) - begin - slept;
+		start = now_ms(CLOCK_MONOTONIC);
+		if (owed > 0)
+			sleep_ms(owed);
+		slept += now_ms(CLOCK_MONOTONIC) - start;
+	} while (done < w->steps);
+	return NULL;
+}
+
+static int find_profile(const char *name)
 {
 	int i;
-	int total_workload = workload*DELAY;
 
-	for (i = 0; i < total_workload; i++)
-		core_delay();
+	for (i = 0; i < (int)(sizeof(profile_names) / sizeof(profile_names[0])); i++)
+		if (!strcmp(name, profile_names[i]))
+			return i;
+	fprintf(stderr, "unknown profile %s\n", name);
+	exit(EXIT_FAILURE);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-p cpu|mem|cache|io|bursty] [-t ms] [-n threads]\n", prog);
+	exit(EXIT_FAILURE);
 }
 
 int main(int argc, char **argv)
 {
-	int workload = LOAD;
+	const char *base = strrchr(argv[0], '/') ? strrchr(argv[0], '/') + 1 : argv[0];
+	const char *env;
+	int profile = CPU, threads = 1, opt, i;
+	long ms = UNIT_MS, busy_ms, calibrated;
+	struct worker *workers;
 	int pid = getpid();
 
+	/* The old binaries: work3 is three units of cpu work */
+	if (!strncmp(base, "work", 4) && base[4] >= '1' && base[4] <= '9')
+		ms = atol(base + 4) * UNIT_MS;
+
+	if ((env = getenv("WORK_PROFILE")))
+		profile = find_profile(env);
+	if ((env = getenv("WORK_MS")))
+		ms = atol(env);
+	if ((env = getenv("WORK_THREADS")))
+		threads = atoi(env);
+
+	while ((opt = getopt(argc, argv, "p:t:n:")) != -1) {
+		switch (opt) {
+		case 'p':
+			profile = find_profile(optarg);
+			break;
+		case 't':
+			ms = atol(optarg);
+			break;
+		case 'n':
+			threads = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (ms <= 0 || threads <= 0)
+		usage(argv[0]);
+
 	printf("process %d begins\n", pid);
-	delay(workload);
-	printf("process %d ends\n", pid);
+	fflush(stdout);
+
+	workers = calloc(threads, sizeof(*workers));
+	if (!workers) {
+		perror("calloc");
+		return EXIT_FAILURE;
+	}
+	for (i = 0; i < threads; i++)
+		worker_init(&workers[i], profile, (uint64_t)pid * 2654435761u + i + 1);
+
+	/*
+	 * Bursty work is cpu work with pauses, so it is measured as cpu work, and
+	 * the pauses take half of the time. The calibration ran without any, so
+	 * the first thread owes that much extra sleep
+	 */
+	busy_ms = profile == BURSTY ? ms / 2 : ms;
+	workers[0].profile = profile == BURSTY ? CPU : profile;
+	calibrated = calibrate(&workers[0], busy_ms);
+	workers[0].profile = profile;
+	if (profile == BURSTY)
+		workers[0].rest_ms = calibrated / steps_per_ms;
 
+	for (i = 0; i < threads; i++) {
+		workers[i].steps = (long)(steps_per_ms * busy_ms);
+		if (i == 0)
+			workers[i].steps -= calibrated;
+		if (pthread_create(&workers[i].thread, NULL, run, &workers[i])) {
+			perror("pthread_create");
+			return EXIT_FAILURE;
+		}
+	}
+	for (i = 0; i < threads; i++) {
+		pthread_join(workers[i].thread, NULL);
+		free(workers[i].buffer);
+		if (workers[i].fd != -1)
+			close(workers[i].fd);
+	}
+	free(workers);
+
+	printf("process %d ends\n", pid);
 	return 0;
 }